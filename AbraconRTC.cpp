@@ -1,10 +1,22 @@
+#include <string.h>
 #include <util/delay.h>
 #include <Wire.h>
 #include "AbraconRTC.h"
+#include "AbraconRTCTrace.h"
+
+using namespace AbraReg;
 
 // Initialize Class Variables //////////////////////////////////////////////////
 
 RTCData AbraRTC::AbraRTCData = {0};
+#if ABRA_RTC_HAS_SET
+RTCConfig AbraRTC::AbraRTCConfig = {0};
+uint8_t AbraRTC::recoveryPolicy = RECOVER_DEFAULT;
+#endif
+uint8_t AbraRTC::powerFlags = 0;
+#if ABRA_RTC_HAS_POWER_LOG
+RTCPowerEvent AbraRTC::powerEvent = {0};
+#endif
 
 // Constructors ////////////////////////////////////////////////////////////////
 
@@ -16,83 +28,87 @@ AbraRTC::AbraRTC()
 
 /*
   Description
-    write RTC register 8 bit value
+    write consecutive RTC registers in one transmission
   Input
-    addr: address of register to write
-    val: value to write to register (0 to 255 or 0x00 to 0xFF)
+    addr: address of first register to write
+    vals: values to write, the RTC auto-increments the register address
+    len: number of registers to write
   Return
     true if success, false if error
 */
-static bool AbraRTC::writeRegister(uint8_t addr, uint8_t val) {
+bool AbraRTC::writeRegisters(uint8_t addr, const uint8_t *vals, uint8_t len) {
+	uint8_t status = 1; // data too long to fit in transmit buffer
+
 	Wire.beginTransmission(RTC_ADDR);
-	if (!Wire.write(addr)) {return 0;} // send address of register to write to
-	if (!Wire.write(val)) {return 0;} // send updated register value
-	Wire.endTransmission();
+	if ((Wire.write(addr) == 1) && (Wire.write(vals, len) == len)) { // send register address then values
+		status = Wire.endTransmission();
+	}
+	ABRA_TRACE_BUS(TRACE_WRITE, addr, vals, len, status);
 
-	return 1;
+	return (status == 0);
 }
 
 /*
   Description
-    select RTC register (likely for reading from)
+    read consecutive RTC registers in one transmission
   Input
-    addr: address of register to select
+    addr: address of first register to read from
+    vals: values read from registers
+    len: number of registers to read
   Return
     true if success, false if error
 */
-static bool AbraRTC::selectRegister(uint8_t addr) {
+bool AbraRTC::readRegisters(uint8_t addr, uint8_t *vals, uint8_t len) {
+	uint8_t status = 1; // data too long to fit in transmit buffer
+
+	// select register to read from
 	Wire.beginTransmission(RTC_ADDR);
-	if (!Wire.write(addr)) {return 0;} // send address of register to select
-	Wire.endTransmission();
+	if (Wire.write(addr) == 1) {
+		status = Wire.endTransmission();
+	}
 
-	return 1;
+	if (status == 0) {
+		Wire.requestFrom((uint8_t)RTC_ADDR, len);
+		if (Wire.available() == len) { // make sure all bytes were returned
+			for (uint8_t i = 0; i < len; i++) {
+				vals[i] = Wire.read();
+			}
+		} else {
+			status = TRACE_SHORT_READ;
+		}
+	}
+	ABRA_TRACE_BUS(TRACE_READ, addr, vals, (status ? 0 : len), status);
+
+	return (status == 0);
 }
 
 /*
   Description
-    read RTC register 8 bit value
+    write RTC register 8 bit value
   Input
-    addr: address of register to read from
-    readVal: value read from register
+    addr: address of register to write
+    val: value to write to register (0 to 255 or 0x00 to 0xFF)
   Return
     true if success, false if error
 */
-static bool AbraRTC::readRegister(uint8_t addr, uint8_t &readVal) {
-	// select register to read from
-	if (!selectRegister(addr)) { return 0; }
-
-	Wire.requestFrom(RTC_ADDR, 1); // request 1 byte for register
-	if (Wire.available() == 1) { // make sure 1 byte was returned
-		readVal = Wire.read();
-		return 1;
-	}
-
-	return 0;
+static bool AbraRTC::writeRegister(uint8_t addr, uint8_t val) {
+	return writeRegisters(addr, &val, 1);
 }
 
 /*
   Description
-    write a specific bit in an RTC register
+    read RTC register 8 bit value
   Input
-    addr: address of register to write
-    bitPosition: position of the bit to write to (0-7)
-    val: bit value to write (0 or 1)
+    addr: address of register to read from
+    readVal: value read from register
   Return
     true if success, false if error
 */
-static bool AbraRTC::writeBit(uint8_t addr, uint8_t bitPosition, bool val) {
-	uint8_t regVal = 0;
-	if (!readRegister(addr, regVal)) { return 0; }
-
-	if (val) {
-		regVal |= (1 << bitPosition);
-	} else {
-		regVal &= ~(1 << bitPosition);
-	}
-
-	return writeRegister(addr, regVal);
+static bool AbraRTC::readRegister(uint8_t addr, uint8_t &readVal) {
+	return readRegisters(addr, &readVal, 1);
 }
 
+#if ABRA_RTC_HAS_SET
 /*
   Description
     switch 12-hour format to 24-hour format
@@ -127,11 +143,7 @@ static uint8_t AbraRTC::hour12to24(uint8_t RTCHourTimeOfDay, uint8_t RTCHourVal1
 		newHourVal10s = 0;
 	}
 
-	// mask any overflow (though there shouldn't be)
-	newHourVal1s  	 &= 0x0F;
-	newHourVal10s 	 &= 0x03;
-
-	return (newHourVal1s | (newHourVal10s << 4) | (newHourFormat << 6));
+	return HOUR_1S::encode(newHourVal1s) | HOUR_10S_24::encode(newHourVal10s) | HOUR_FMT::encode(newHourFormat);
 }
 
 /*
@@ -177,14 +189,73 @@ static uint8_t AbraRTC::hour24to12(uint8_t RTCHourVal1s, uint8_t RTCHourVal10s)
 		newHourTimeOfDay = 0;
 	}
 
-	// mask any overflow (though there shouldn't be)
-	newHourVal1s  	 &= 0x0F;
-	newHourVal10s 	 &= 0x01;
+	return HOUR_1S::encode(newHourVal1s) | HOUR_10S_12::encode(newHourVal10s) | HOUR_PM::encode(newHourTimeOfDay) | HOUR_FMT::encode(newHourFormat);
+}
 
-	return (newHourVal1s | (newHourVal10s << 4) | (newHourTimeOfDay << 5) | (newHourFormat << 6));
+/*
+  Description
+    convert an hour register value between 12-hour and 24-hour format
+  Input
+    RTCHourVal: current hour register value
+    newHrFormat: true for 12-hour format, false for 24-hour format
+  Return
+    new value to load into the RTC hour register
+*/
+uint8_t AbraRTC::convertHrFormat(uint8_t RTCHourVal, bool newHrFormat) {
+	bool	RTCHourFormat = HOUR_FMT::get(RTCHourVal); // true for 12-hour, false for 24-hour
+
+	if (RTCHourFormat == newHrFormat) {
+		return RTCHourVal; // nothing to change
+	}
+
+	if (RTCHourFormat) { // 12-hour to 24-hour
+		return hour12to24(HOUR_PM::get(RTCHourVal), HOUR_1S::get(RTCHourVal), HOUR_10S_12::get(RTCHourVal));
+	} else { // 24-hour to 12-hour
+		return hour24to12(HOUR_1S::get(RTCHourVal), HOUR_10S_24::get(RTCHourVal));
+	}
+}
+
+/*
+  Description
+    build the hour register value for an hour in the given format
+  Input
+    hour: hour to set to (1-12 for 12-hour format, 0-23 for 24-hour format)
+    PM: true for PM, false for AM
+    hrFormat: true for 12-hour format, false for 24-hour format
+    hourVal: new value to load into the RTC hour register
+  Return
+    true if success, false if hour is out of range
+*/
+bool AbraRTC::encodeHour(uint8_t hour, bool PM, bool hrFormat, uint8_t &hourVal) {
+	if (hrFormat) { // 12-hour mode
+		if (hour > 12) {
+			return 0;
+		}
+		if (hour == 0) {
+			hour = 12;
+		}
+		uint8_t RTCHourVal1s  = hour % 10;
+		uint8_t RTCHourVal10s = (hour - RTCHourVal1s)/10;
+		hourVal = HOUR_1S::encode(RTCHourVal1s) | HOUR_10S_12::encode(RTCHourVal10s) | HOUR_PM::encode(PM) | HOUR_FMT::encode(hrFormat);
+	} else { // 24-hour mode
+		if (hour >= 24) {
+			return 0;
+		}
+		if (PM) { // weird case where someone puts in 12-hour format but time is set to 24-hour format
+			if ((hour + 12) < 24) {
+				hour += 12;
+			}
+		}
+		uint8_t RTCHourVal1s  = hour % 10;
+		uint8_t RTCHourVal10s = (hour - RTCHourVal1s)/10;
+		hourVal = HOUR_1S::encode(RTCHourVal1s) | HOUR_10S_24::encode(RTCHourVal10s) | HOUR_FMT::encode(hrFormat);
+	}
 
+	return 1;
 }
+#endif
 
+#if ABRA_RTC_HAS_CONFIG
 /*
   Description
     check control status register to see if EEPROM is busy
@@ -192,34 +263,177 @@ static uint8_t AbraRTC::hour24to12(uint8_t RTCHourVal1s, uint8_t RTCHourVal10s)
     true if busy, false if not busy
 */
 static bool AbraRTC::checkEEPROMBusy() {
-	uint8_t ctlStatRegVal = 0;
-	if(!readRegister(CTL_STAT_ADDR, ctlStatRegVal)) { return 1; } // can't read EEPROM stat register, try again
-	return ((ctlStatRegVal & 0x80) >> 7);
+	uint8_t EEBusy = 0;
+	if (!readField<STAT_EEBUSY>(EEBusy)) { return 1; } // can't read EEPROM stat register, try again
+	return EEBusy;
+}
+
+/*
+  Description
+    write the EEPROM control register, EEPROM refresh must already be disabled
+  Input
+    EECtlVal: value to write to the EEPROM control register
+    ctl1Val: control 1 register value to restore afterwards, with EEPROM refresh
+      enabled unless it is to stay off
+  Return
+    true if success, false if error
+*/
+bool AbraRTC::writeEECtl(uint8_t EECtlVal, uint8_t ctl1Val) {
+	// wait for EEPROM to not be busy
+	while (checkEEPROMBusy());
+
+	if (!writeRegister(EE_CTL_ADDR, EECtlVal)) { return 0; }
+	_delay_ms(10);
+
+	// renable EEPROM refresh
+	return writeRegister(CTL_1_ADDR, ctl1Val);
+}
+#endif
+
+#if ABRA_RTC_HAS_POWER_LOG
+/*
+  Description
+    convert sec, min, hour register values to seconds since midnight
+  Input
+    timeVals: sec, min and hour register values, bit 7 is ignored
+  Return
+    seconds since midnight (0-86399)
+*/
+uint32_t AbraRTC::timeToSecOfDay(const uint8_t *timeVals) {
+	uint8_t hour = 0;
+	if (HOUR_FMT::get(timeVals[2])) { // 12-hour format, 12 AM is midnight
+		hour = (HOUR_10S_12::get(timeVals[2]) * 10 + HOUR_1S::get(timeVals[2])) % 12;
+		if (HOUR_PM::get(timeVals[2])) {
+			hour += 12;
+		}
+	} else {
+		hour = HOUR_10S_24::get(timeVals[2]) * 10 + HOUR_1S::get(timeVals[2]);
+	}
+
+	return (hour * 3600UL) + ((MIN_10S::get(timeVals[1]) * 10 + MIN_1S::get(timeVals[1])) * 60UL) +
+		(SEC_10S::get(timeVals[0]) * 10 + SEC_1S::get(timeVals[0]));
 }
 
+/*
+  Description
+    decode the power event log
+  Input
+    logVals: event entry then logAlive() entry, as kept in user RAM
+    event: decoded power event
+*/
+void AbraRTC::decodePowerLog(const uint8_t *logVals, RTCPowerEvent &event) {
+	event.flags      = 0;
+	event.aliveValid = 1;
+	for (uint8_t i = 0; i < 4; i++) {
+		if (logVals[i] & POWER_LOG_BIT) {
+			event.flags |= (1 << i);
+		}
+		if (!(logVals[4 + i] & POWER_LOG_BIT)) {
+			event.aliveValid = 0;
+		}
+	}
+	event.secOfDay      = timeToSecOfDay(&logVals[0]);
+	event.aliveSecOfDay = timeToSecOfDay(&logVals[4]);
+
+	// the log has no month, so only an event on the same date as logAlive() gives a downtime
+	bool sameDate = !((logVals[3] ^ logVals[7]) & (DATE_1S::mask | DATE_10S::mask));
+	event.downSeconds = -1;
+	if (event.flags && event.aliveValid && sameDate && (event.secOfDay >= event.aliveSecOfDay)) {
+		event.downSeconds = event.secOfDay - event.aliveSecOfDay;
+	}
+}
+#endif
+
 // Public Methods //////////////////////////////////////////////////////////////
 
 /*
   Description
-    begin RTC by checking if power was lost and enabling tricklecharge if so
+    begin RTC by reading and clearing the power status flags, logging any power
+    event to RTC user RAM and recovering as set by setRecoveryPolicy()
   Return
 	true if success, false if error
 */
 bool AbraRTC::begin() {
-	// clear PON flag if set
-	uint8_t ctlStatRegVal = 0;
-	if (!readRegister(CTL_STAT_ADDR, ctlStatRegVal)) { return 0; }
-	uint8_t PONFlag = (ctlStatRegVal & 0x20) >> 5;
+	ABRA_TRACE_CALL(TRACE_CALL_BEGIN);
 
-	if (PONFlag) {
-		// update EEPROM control register / reset PON flag
-		ctlStatRegVal &= 0xDF; // set PON flag to 0
-		if (!writeRegister(CTL_STAT_ADDR, ctlStatRegVal)) { return 0; }
+	// read interrupt flag and status registers in one burst
+	uint8_t flagVals[2]; // CTL_INT_FLAG_ADDR, CTL_STAT_ADDR
+	if (!readRegisters(CTL_INT_FLAG_ADDR, flagVals, 2)) { return 0; }
 
-		// enable trickle charger
-		if (!setTrickleCharge(1)) { return 0; }
+	powerFlags = 0;
+	if (STAT_PON::get(flagVals[1])) {
+		powerFlags |= POWER_PON;
+	}
+	if (STAT_SR::get(flagVals[1]) || INTF_SRF::get(flagVals[0])) {
+		powerFlags |= POWER_SR;
+	}
+	if (STAT_V1F::get(flagVals[1]) || INTF_V1IF::get(flagVals[0])) {
+		powerFlags |= POWER_LOW_V1;
+	}
+	if (STAT_V2F::get(flagVals[1]) || INTF_V2IF::get(flagVals[0])) {
+		powerFlags |= POWER_LOW_V2;
+	}
 
-		if (!setTime()) { return 0; }
+	if (powerFlags) {
+#if ABRA_RTC_HAS_POWER_LOG
+		// time and date the event was found, before any recovery changes it
+		uint8_t logVals[8] = {0}; // event entry, then the logAlive() entry from before the event
+		if (!readRegisters(SEC_ADDR, logVals, 4)) { return 0; }
+		for (uint8_t i = 0; i < 4; i++) {
+			if (powerFlags & (1 << i)) {
+				logVals[i] |= POWER_LOG_BIT;
+			}
+		}
+
+		// the downtime is worked out now, the next logAlive() replaces the time it needs,
+		// RAM was lost too on power-on reset so the logAlive() time is cleared with it
+		if (!(powerFlags & POWER_PON)) {
+			if (!readRegisters(POWER_ALIVE_ADDR, &logVals[4], 4)) { return 0; }
+		}
+		decodePowerLog(logVals, powerEvent);
+
+		// log the event before clearing the flags, so losing power in between doesn't lose it
+		if (!writeRegisters(POWER_EVENT_ADDR, logVals, (powerFlags & POWER_PON) ? 8 : 4)) { return 0; }
+#endif
+
+		// clear the power flags found set by writing them 0, the other flags are written 1 so
+		// any set since and the alarm and timer flags are left as the RTC has them
+		uint8_t clearVals[2]; // CTL_INT_FLAG_ADDR, CTL_STAT_ADDR
+		clearVals[0] = ~(flagVals[0] & (INTF_SRF::mask | INTF_V1IF::mask | INTF_V2IF::mask));
+		clearVals[1] = ~(flagVals[1] & (STAT_PON::mask | STAT_SR::mask | STAT_V1F::mask | STAT_V2F::mask));
+		if (!writeRegisters(CTL_INT_FLAG_ADDR, clearVals, 2)) { return 0; }
+
+#if ABRA_RTC_HAS_SET
+		// recover directly rather than through commitConfig(), which a sketch that never
+		// sets the time or configuration would otherwise carry for begin() alone
+		bool timeLost = (powerFlags & POWER_PON) ||
+			((powerFlags & POWER_LOW_V2) && (recoveryPolicy & RECOVER_ON_LOW_V2));
+		if (timeLost) {
+#if ABRA_RTC_HAS_CONFIG
+			if (recoveryPolicy & RECOVER_TRICKLE) {
+				// enable trickle charger, only written if not already enabled
+				uint8_t EECtlVal = 0;
+				if (!readRegister(EE_CTL_ADDR, EECtlVal)) { return 0; }
+				if (!EECTL_R1K::get(EECtlVal)) {
+					uint8_t ctl1Val = 0;
+					if (!readRegister(CTL_1_ADDR, ctl1Val)) { return 0; }
+					if (!writeRegister(CTL_1_ADDR, CTL1_EERE::set(ctl1Val, 0))) { return 0; }
+					if (!writeEECtl(EECTL_R1K::set(EECtlVal, 1), ctl1Val)) { return 0; }
+				}
+			}
+#endif
+			if (recoveryPolicy & RECOVER_SET_TIME) {
+				// reset time to midnight, 12 AM in 12-hour format
+				uint8_t RTCHourVal = 0;
+				if (!readRegister(HOUR_ADDR, RTCHourVal)) { return 0; }
+				uint8_t newTimeVals[3] = {0, 0, 0}; // sec, min, hour
+				if (HOUR_FMT::get(RTCHourVal)) {
+					newTimeVals[2] = HOUR_1S::encode(2) | HOUR_10S_12::encode(1) | HOUR_FMT::encode(1);
+				}
+				if (!writeRegisters(SEC_ADDR, newTimeVals, 3)) { return 0; }
+			}
+		}
+#endif
 	}
 
 	if (!updateRTC()) { return 0; }
@@ -234,51 +448,114 @@ bool AbraRTC::begin() {
     true if success, false if error
 */
 bool AbraRTC::updateRTC() {
-	// select seconds register to begin reading from
-	selectRegister(SEC_ADDR);
+	ABRA_TRACE_CALL(TRACE_CALL_UPDATE);
 
-	Wire.requestFrom(RTC_ADDR, 3); // request 3 bytes for sec, min, hour
-	if (Wire.available() == 3) { // make sure 3 bytes were returned
-		uint8_t RTCSecVal  = Wire.read();
-		AbraRTCData.sec1s   = RTCSecVal & 0x0F;
-		AbraRTCData.sec10s  = (RTCSecVal >> 4) & 0x0F;
+	// read sec, min, hour registers in one burst
+	uint8_t RTCTimeVals[3];
+	if (readRegisters(SEC_ADDR, RTCTimeVals, 3)) {
+		uint8_t RTCSecVal  = RTCTimeVals[0];
+		AbraRTCData.sec1s   = SEC_1S::get(RTCSecVal);
+		AbraRTCData.sec10s  = SEC_10S::get(RTCSecVal);
 
-		uint8_t RTCMinVal  = Wire.read();
-		AbraRTCData.min1s   = RTCMinVal & 0x0F;
-		AbraRTCData.min10s  = (RTCMinVal >> 4) & 0x0F;
+		uint8_t RTCMinVal  = RTCTimeVals[1];
+		AbraRTCData.min1s   = MIN_1S::get(RTCMinVal);
+		AbraRTCData.min10s  = MIN_10S::get(RTCMinVal);
 
-		uint8_t RTCHourVal = Wire.read();
-		AbraRTCData.hrFormat  = (RTCHourVal >> 6) & 0x01;
+		uint8_t RTCHourVal = RTCTimeVals[2];
+		AbraRTCData.hrFormat  = HOUR_FMT::get(RTCHourVal);
 		if (AbraRTCData.hrFormat) { // 12-hour format
-			AbraRTCData.timeOfDay = (RTCHourVal >> 5) & 0x01;
-			AbraRTCData.hour1s    = RTCHourVal & 0x0F;
-			AbraRTCData.hour10s   = (RTCHourVal >> 4) & 0x01;
+			AbraRTCData.timeOfDay = HOUR_PM::get(RTCHourVal);
+			AbraRTCData.hour1s    = HOUR_1S::get(RTCHourVal);
+			AbraRTCData.hour10s   = HOUR_10S_12::get(RTCHourVal);
 		} else { // 24-hour format
-			AbraRTCData.hour1s    = RTCHourVal & 0x0F;
-			AbraRTCData.hour10s   = (RTCHourVal >> 4) & 0x03;
+			AbraRTCData.hour1s    = HOUR_1S::get(RTCHourVal);
+			AbraRTCData.hour10s   = HOUR_10S_24::get(RTCHourVal);
 		}
 	} else { // something went wrong and we didn't get all 3 time registers
 		return 0;
 	}
 
-	// get temperature
-	// select seconds register to begin reading from
-	selectRegister(TEMP_ADDR);
-
-	Wire.requestFrom(RTC_ADDR, 1); // request 1 byte for temperature
-	if (Wire.available() == 1) { // make sure 1 byte was returned
-		uint8_t RTCTempC = Wire.read() - 60;
-		AbraRTCData.tempF  = RTCTempC * 1.8 + 32;
+#if ABRA_RTC_HAS_TEMP
+	// get temperature, integer math avoids linking the floating point library
+	uint8_t RTCTempVal = 0;
+	if (readRegister(TEMP_ADDR, RTCTempVal)) {
+		int16_t RTCTempC = (int16_t)RTCTempVal - 60;
+		AbraRTCData.tempF  = RTCTempC * 9 / 5 + 32;
 	} else {
 		return 0;
 	}
+#endif
 
 	return 1;
 }
 
 /*
   Description
-    set the time of the RTC
+    seconds since midnight of the time read by the last updateRTC()
+  Return
+    seconds since midnight (0-86399)
+*/
+uint32_t AbraRTC::getSecOfDay() {
+	uint8_t hour = AbraRTCData.hour10s * 10 + AbraRTCData.hour1s;
+	if (AbraRTCData.hrFormat) { // 12-hour format, 12 AM is midnight
+		hour %= 12;
+		if (AbraRTCData.timeOfDay) {
+			hour += 12;
+		}
+	}
+
+	return (hour * 3600UL) + ((AbraRTCData.min10s * 10 + AbraRTCData.min1s) * 60UL) +
+		(AbraRTCData.sec10s * 10 + AbraRTCData.sec1s);
+}
+
+/*
+  Description
+    read bits of a register, used by readField()
+  Input
+    addr: address of register to read from
+    mask: bits to read
+    val: register value read, with bits outside mask cleared
+  Return
+    true if success, false if error
+*/
+bool AbraRTC::readBits(uint8_t addr, uint8_t mask, uint8_t &val) {
+	ABRA_TRACE_CALL(TRACE_CALL_READ_FIELD, addr, mask);
+
+	uint8_t regVal = 0;
+	if (!readRegister(addr, regVal)) { return 0; }
+	val = regVal & mask;
+
+	return 1;
+}
+
+/*
+  Description
+    write bits of a register in a single write, used by writeField()
+    the register is only read first if mask doesn't cover all 8 bits, and
+    never for the interrupt flag and status registers, where the flags
+    outside mask are written 1 to leave them as the RTC has them
+  Input
+    addr: address of register to write
+    mask: bits to change
+    val: new value of the masked bits
+  Return
+    true if success, false if error
+*/
+bool AbraRTC::writeBits(uint8_t addr, uint8_t mask, uint8_t val) {
+	ABRA_TRACE_CALL(TRACE_CALL_WRITE_FIELD, addr, mask, val);
+
+	uint8_t regVal = 0xFF;
+	if (!isFlagRegister(addr) && (mask != 0xFF)) {
+		if (!readRegister(addr, regVal)) { return 0; }
+	}
+
+	return writeRegister(addr, (regVal & ~mask) | (val & mask));
+}
+
+#if ABRA_RTC_HAS_SET
+/*
+  Description
+    set the time of the RTC, committing any other staged changes with it
     default call sets RTC to midnight
   Input
     hour: hour to set to (1-12 for 12-hour format, 0-23 for 24-hour format)
@@ -289,71 +566,11 @@ bool AbraRTC::updateRTC() {
     true if success, false if error
 */
 bool AbraRTC::setTime(uint8_t hour=0, uint8_t min=0, uint8_t sec=0, bool PM=0) {
-	// select hour register to get 12/24-hr preference
-	if (!selectRegister(HOUR_ADDR)) {
-		return 0;
-	}
-
-	uint8_t newHourVal    = 0;
-	uint8_t newMinVal     = 0;
-	uint8_t newSecVal     = 0;
-
-	if ((min < 60 && min >= 0) && (sec < 60 && sec >= 0)) {
-		uint8_t RTCMinVal1s   = min % 10;
-		uint8_t RTCMinVal10s  = (min - RTCMinVal1s)/10;
-		uint8_t RTCSecVal1s   = sec % 10;
-		uint8_t RTCSecVal10s  = (sec - RTCSecVal1s)/10;
-		newMinVal = RTCMinVal1s | (RTCMinVal10s << 4);
-		newSecVal = RTCSecVal1s | (RTCSecVal10s << 4);
-	} else {
-		return 0;
-	}
-
-	Wire.requestFrom(RTC_ADDR, 1); // request 1 byte for hour
-	if (Wire.available() == 1) { // make sure 1 byte was returned
-		uint8_t RTCHourVal = Wire.read();
-		bool RTCHourFormat = (RTCHourVal >> 6) & 0x01;
-		if (RTCHourFormat) { // 12-hour mode
-			if (hour <= 12 && hour >= 0) {
-				if (hour == 0) {
-					hour = 12;
-				}
-				uint8_t RTCHourVal1s  = hour % 10;
-				uint8_t RTCHourVal10s = (hour - RTCHourVal1s)/10;
-				bool RTCHourTimeOfDay = 0;
-				if (PM) { // afternoon
-					RTCHourTimeOfDay = 1;
-				}
-				newHourVal = RTCHourVal1s | (RTCHourVal10s << 4) | (RTCHourTimeOfDay << 5) | (RTCHourFormat << 6);
-			} else {
-				return 0;
-			}
-		} else { // 24-hour mode
-			if (hour < 24 && hour >= 0) {
-				if (PM) { // weird case where someone puts in 12-hour format but time is set to 24-hour format
-					if ((hour + 12) < 24) {
-						hour += 12;
-					}
-				}
-				uint8_t RTCHourVal1s  = hour % 10;
-				uint8_t RTCHourVal10s = (hour - RTCHourVal1s)/10;
-				newHourVal = RTCHourVal1s | (RTCHourVal10s << 4) | (RTCHourFormat << 6);
-			} else {
-				return 0;
-			}
-		}
-	} else {
-		return 0;
-	}
+	ABRA_TRACE_CALL(TRACE_CALL_SET_TIME, hour, min, sec, PM);
 
-	Wire.beginTransmission(RTC_ADDR);
-	if (Wire.write(SEC_ADDR)  != 1) {return 0;} // send address of register to write to
-	if (Wire.write(newSecVal) != 1) {return 0;} // send updated register value
-	if (Wire.write(newMinVal) != 1) {return 0;} // send updated register value
-	if (Wire.write(newHourVal) != 1) {return 0;} // send updated register value
-	Wire.endTransmission();
+	if (!stageTime(hour, min, sec, PM)) { return 0; }
 
-	return 1;
+	return commitConfig();
 }
 
 /*
@@ -363,33 +580,13 @@ bool AbraRTC::setTime(uint8_t hour=0, uint8_t min=0, uint8_t sec=0, bool PM=0) {
     true if success, false if error
 */
 static bool AbraRTC::toggleHrFormat() {
+	ABRA_TRACE_CALL(TRACE_CALL_TOGGLE_HR_FORMAT);
+
 	uint8_t RTCHourVal = 0;
 	if (!readRegister(HOUR_ADDR, RTCHourVal)) { return 0; }
 
-	bool	RTCHourFormat = (RTCHourVal >> 6) & 0x01; // true for 12-hour, false for 24-hour
-
-	bool	RTCHourTimeOfDay = 0; // true for PM, false for AM
-	uint8_t RTCHourVal1s     = 0;
-	uint8_t RTCHourVal10s    = 0;
-	uint8_t newHourVal 		 = 0;
-
-	if (RTCHourFormat) {
-		RTCHourTimeOfDay = (RTCHourVal >> 5) & 0x01;
-		RTCHourVal1s     = RTCHourVal & 0x0F;
-		RTCHourVal10s    = (RTCHourVal >> 4) & 0x01;
-	} else {
-		RTCHourVal1s     = RTCHourVal & 0x0F;
-		RTCHourVal10s    = (RTCHourVal >> 4) & 0x03;
-	}
-
-	if (RTCHourFormat) { // 12-hour to 24-hour
-		newHourVal = hour12to24(RTCHourTimeOfDay, RTCHourVal1s, RTCHourVal10s);
-	} else { // 24-hour to 12-hour
-		newHourVal = hour24to12(RTCHourVal1s, RTCHourVal10s);
-	}
-
 	// update hour register
-	if (!writeRegister(HOUR_ADDR, newHourVal)) {
+	if (!writeRegister(HOUR_ADDR, convertHrFormat(RTCHourVal, !HOUR_FMT::get(RTCHourVal)))) {
 		return 0;
 	}
 
@@ -398,49 +595,18 @@ static bool AbraRTC::toggleHrFormat() {
 
 /*
   Description
-    set clock to 12-hour format to 24-hour format
+    set clock to 12-hour format or 24-hour format, committing any other staged changes with it
   Input
     newHrFormat: true for 12-hour format, false for 24-hour format
   Return
     true if success, false if error
 */
 bool AbraRTC::setHrFormat(bool newHrFormat) {
-	uint8_t RTCHourVal = 0;
-	if (!readRegister(HOUR_ADDR, RTCHourVal)) { return 0; }
-
-	bool	RTCHourFormat = (RTCHourVal >> 6) & 0x01; // true for 12-hour, false for 24-hour
+	ABRA_TRACE_CALL(TRACE_CALL_SET_HR_FORMAT, newHrFormat);
 
-	if (RTCHourFormat == newHrFormat) {
-		return 1; // nothing to change
-	}
-
-	bool	RTCHourTimeOfDay = 0; // true for PM, false for AM
-	uint8_t RTCHourVal1s     = 0;
-	uint8_t RTCHourVal10s    = 0;
-	uint8_t newHourVal 		 = 0;
+	stageHrFormat(newHrFormat);
 
-	if (RTCHourFormat) {
-		RTCHourTimeOfDay = (RTCHourVal >> 5) & 0x01;
-		RTCHourVal1s     = RTCHourVal & 0x0F;
-		RTCHourVal10s    = (RTCHourVal >> 4) & 0x01;
-	} else {
-		RTCHourVal1s     = RTCHourVal & 0x0F;
-		RTCHourVal10s    = (RTCHourVal >> 4) & 0x03;
-	}
-
-	// reformat hour data for set format
-	if (newHrFormat) { // 24-hour to 12-hour
-		newHourVal = hour24to12(RTCHourVal1s, RTCHourVal10s);
-	} else { // 12-hour to 24-hour
-		newHourVal = hour12to24(RTCHourTimeOfDay, RTCHourVal1s, RTCHourVal10s);
-	}
-
-	// update hour register
-	if (!writeRegister(HOUR_ADDR, newHourVal)) {
-		return 0;
-	}
-
-	return 1;
+	return commitConfig();
 }
 
 /*
@@ -450,22 +616,24 @@ bool AbraRTC::setHrFormat(bool newHrFormat) {
     true if success, false if error
 */
 static bool AbraRTC::incHour() {
+	ABRA_TRACE_CALL(TRACE_CALL_INC_HOUR);
+
 	// get current hour
 	uint8_t RTCHourVal = 0;
 	if (!readRegister(HOUR_ADDR, RTCHourVal)) { return 0; }
 
-	bool	RTCHourFormat = (RTCHourVal >> 6) & 0x01; // true for 12-hour, false for 24-hour
+	bool	RTCHourFormat = HOUR_FMT::get(RTCHourVal); // true for 12-hour, false for 24-hour
 	bool	RTCHourTimeOfDay = 0; // true for PM, false for AM
 	uint8_t RTCHourVal1s     = 0;
 	uint8_t RTCHourVal10s    = 0;
 
 	if (RTCHourFormat) {
-		RTCHourTimeOfDay = (RTCHourVal >> 5) & 0x01;
-		RTCHourVal1s     = RTCHourVal & 0x0F;
-		RTCHourVal10s    = (RTCHourVal >> 4) & 0x01;
+		RTCHourTimeOfDay = HOUR_PM::get(RTCHourVal);
+		RTCHourVal1s     = HOUR_1S::get(RTCHourVal);
+		RTCHourVal10s    = HOUR_10S_12::get(RTCHourVal);
 	} else {
-		RTCHourVal1s     = RTCHourVal & 0x0F;
-		RTCHourVal10s    = (RTCHourVal >> 4) & 0x03;
+		RTCHourVal1s     = HOUR_1S::get(RTCHourVal);
+		RTCHourVal10s    = HOUR_10S_24::get(RTCHourVal);
 	}
 
 	// increment hour
@@ -490,9 +658,7 @@ static bool AbraRTC::incHour() {
 			RTCHourVal1s++;
 		}
 
-		// mask any overflow (though there shouldn't be)
-		RTCHourVal1s  	 &= 0x0F;
-		newHourVal = RTCHourVal1s | (RTCHourVal10s << 4) | (RTCHourTimeOfDay << 5) | (RTCHourFormat << 6);
+		newHourVal = HOUR_1S::encode(RTCHourVal1s) | HOUR_10S_12::encode(RTCHourVal10s) | HOUR_PM::encode(RTCHourTimeOfDay) | HOUR_FMT::encode(RTCHourFormat);
 
 	} else { // 24-hour format
 		if (RTCHourVal10s == 2) {
@@ -510,10 +676,7 @@ static bool AbraRTC::incHour() {
 			RTCHourVal1s++;
 		}
 		
-		// mask any overflow (though there shouldn't be)
-		RTCHourVal1s  	 &= 0x0F;
-		RTCHourVal10s 	 &= 0x03;
-		newHourVal = (RTCHourVal1s & 0x0F) | (RTCHourVal10s << 4) | (RTCHourFormat << 6);
+		newHourVal = HOUR_1S::encode(RTCHourVal1s) | HOUR_10S_24::encode(RTCHourVal10s) | HOUR_FMT::encode(RTCHourFormat);
 	}
 
 	// update hour register
@@ -531,27 +694,24 @@ static bool AbraRTC::incHour() {
     true if success, false if error
 */
 static bool AbraRTC::decHour() {
-	// get hour register data
-	if (!selectRegister(HOUR_ADDR)) {
-		return 0;
-	}
+	ABRA_TRACE_CALL(TRACE_CALL_DEC_HOUR);
 
 	bool	RTCHourFormat    = 0; // true for 12-hour, false for 24-hour
 	bool	RTCHourTimeOfDay = 0; // true for PM, false for AM
 	uint8_t RTCHourVal1s     = 0;
 	uint8_t RTCHourVal10s    = 0;
 
-	Wire.requestFrom(RTC_ADDR, 1); // request 1 byte for hour
-	if (Wire.available() == 1) { // make sure 1 byte was returned
-		uint8_t RTCHourVal = Wire.read();
-		RTCHourFormat = (RTCHourVal >> 6) & 0x01;
+	// get hour register data
+	uint8_t RTCHourVal = 0;
+	if (readRegister(HOUR_ADDR, RTCHourVal)) {
+		RTCHourFormat = HOUR_FMT::get(RTCHourVal);
 		if (RTCHourFormat) {
-			RTCHourTimeOfDay = (RTCHourVal >> 5) & 0x01;
-			RTCHourVal1s     = RTCHourVal & 0x0F;
-			RTCHourVal10s    = (RTCHourVal >> 4) & 0x01;
+			RTCHourTimeOfDay = HOUR_PM::get(RTCHourVal);
+			RTCHourVal1s     = HOUR_1S::get(RTCHourVal);
+			RTCHourVal10s    = HOUR_10S_12::get(RTCHourVal);
 		} else {
-			RTCHourVal1s     = RTCHourVal & 0x0F;
-			RTCHourVal10s    = (RTCHourVal >> 4) & 0x03;
+			RTCHourVal1s     = HOUR_1S::get(RTCHourVal);
+			RTCHourVal10s    = HOUR_10S_24::get(RTCHourVal);
 		}
 	} else {
 		return 0;
@@ -579,9 +739,7 @@ static bool AbraRTC::decHour() {
 			RTCHourVal1s--;
 		}
 
-		// mask any overflow (though there shouldn't be)
-		RTCHourVal1s  	 &= 0x0F;
-		newHourVal = RTCHourVal1s | (RTCHourVal10s << 4) | (RTCHourTimeOfDay << 5) | (RTCHourFormat << 6);
+		newHourVal = HOUR_1S::encode(RTCHourVal1s) | HOUR_10S_12::encode(RTCHourVal10s) | HOUR_PM::encode(RTCHourTimeOfDay) | HOUR_FMT::encode(RTCHourFormat);
 
 	} else {
 		if (RTCHourVal10s > 0) {
@@ -600,10 +758,7 @@ static bool AbraRTC::decHour() {
 			}
 		}
 
-		// mask any overflow (though there shouldn't be)
-		RTCHourVal1s  	 &= 0x0F;
-		RTCHourVal10s 	 &= 0x03;
-		newHourVal = RTCHourVal1s | (RTCHourVal10s << 4) | (RTCHourFormat << 6);
+		newHourVal = HOUR_1S::encode(RTCHourVal1s) | HOUR_10S_24::encode(RTCHourVal10s) | HOUR_FMT::encode(RTCHourFormat);
 	}
 
 	// update hour register
@@ -621,19 +776,16 @@ static bool AbraRTC::decHour() {
     true if success, false if error
 */
 static bool AbraRTC::incMin() {
-	// get minute register data
-	if (!selectRegister(MIN_ADDR)) {
-		return 0;
-	}
+	ABRA_TRACE_CALL(TRACE_CALL_INC_MIN);
 
 	uint8_t RTCMinVal1s  = 0;
 	uint8_t RTCMinVal10s = 0;
 
-	Wire.requestFrom(RTC_ADDR, 1); // request 1 byte for minute
-	if (Wire.available() == 1) { // make sure 1 byte was returned
-		uint8_t RTCMinVal = Wire.read();
-		RTCMinVal1s  = RTCMinVal & 0x0F;
-		RTCMinVal10s = (RTCMinVal >> 4) & 0x0F;
+	// get minute register data
+	uint8_t RTCMinVal = 0;
+	if (readRegister(MIN_ADDR, RTCMinVal)) {
+		RTCMinVal1s  = MIN_1S::get(RTCMinVal);
+		RTCMinVal10s = MIN_10S::get(RTCMinVal);
 	} else {
 		return 0;
 	}
@@ -653,7 +805,7 @@ static bool AbraRTC::incMin() {
 	} else {
 		RTCMinVal1s++;
 	}
-	uint8_t newMinVal = RTCMinVal1s | (RTCMinVal10s << 4);
+	uint8_t newMinVal = MIN_1S::encode(RTCMinVal1s) | MIN_10S::encode(RTCMinVal10s);
 
 	// update min register
 	if (!writeRegister(MIN_ADDR, newMinVal)) {
@@ -670,19 +822,16 @@ static bool AbraRTC::incMin() {
     true if success, false if error
 */
 static bool AbraRTC::decMin() {
-	// select minute register data
-	if (!selectRegister(MIN_ADDR)) {
-		return 0;
-	}
+	ABRA_TRACE_CALL(TRACE_CALL_DEC_MIN);
 
 	uint8_t RTCMinVal1s  = 0;
 	uint8_t RTCMinVal10s = 0;
 
-	Wire.requestFrom(RTC_ADDR, 1); // request 1 byte for minute
-	if (Wire.available() == 1) { // make sure 1 byte was returned
-		uint8_t RTCMinVal = Wire.read();
-		RTCMinVal1s  = RTCMinVal & 0x0F;
-		RTCMinVal10s = (RTCMinVal >> 4) & 0x0F;
+	// get minute register data
+	uint8_t RTCMinVal = 0;
+	if (readRegister(MIN_ADDR, RTCMinVal)) {
+		RTCMinVal1s  = MIN_1S::get(RTCMinVal);
+		RTCMinVal10s = MIN_10S::get(RTCMinVal);
 	} else {
 		return 0;
 	}
@@ -698,7 +847,7 @@ static bool AbraRTC::decMin() {
 	} else {
 		RTCMinVal1s--;
 	}
-	uint8_t newMinVal = RTCMinVal1s | (RTCMinVal10s << 4);
+	uint8_t newMinVal = MIN_1S::encode(RTCMinVal1s) | MIN_10S::encode(RTCMinVal10s);
 
 	// update min register
 	if (!writeRegister(MIN_ADDR, newMinVal)) {
@@ -707,29 +856,333 @@ static bool AbraRTC::decMin() {
 
 	return 1;
 }
+#endif
 
+#if ABRA_RTC_HAS_CONFIG
 /*
   Description
-    turn trickle charge on (1.5k Ohm internal resistance) or off
+    turn trickle charge on (1.5k Ohm internal resistance) or off,
+    committing any other staged changes with it
   Input
     enableTC: true to enable trickle charger, false to disable it
   Return
     true if success, false if error
 */
 bool AbraRTC::setTrickleCharge(bool enableTC) {
-	// disable EEPROM refresh
-	if (!writeBit(CTL_1_ADDR, 3, 0)) { return 0; }
+	ABRA_TRACE_CALL(TRACE_CALL_SET_TRICKLE_CHARGE, enableTC);
 
-	// wait for EEPROM to not be busy
-	while (checkEEPROMBusy());
+	stageTrickleCharge(enableTC);
 
-	// write EEPROM trickle charge setting
-	// 1.5k Ohm if enabled
-	if (!writeBit(EE_CTL_ADDR, 4, enableTC)) { return 0; }
-	_delay_ms(10);
+	return commitConfig();
+}
 
-	// renable EEPROM refresh
-	if (!writeBit(CTL_1_ADDR, 3, 1)) { return 0; }
+/*
+  Description
+    select the CLKOUT frequency, committing any other staged changes with it
+    the frequency is kept in EEPROM, which is only written if it changes
+  Input
+    freq: CLKOUT_32768HZ, CLKOUT_1024HZ, CLKOUT_32HZ or CLKOUT_1HZ
+  Return
+    true if success, false if error
+*/
+bool AbraRTC::setClkOut(uint8_t freq) {
+	ABRA_TRACE_CALL(TRACE_CALL_SET_CLKOUT, freq);
+
+	if (freq > CLKOUT_1HZ) {
+		return 0;
+	}
+	stageField<EECTL_FD>(freq);
+
+	return commitConfig();
+}
+
+/*
+  Description
+    turn the CLKOUT signal on or off, committing any other staged changes with it
+    the CLKOE pin must also be high for the clock to appear on CLKOUT
+  Input
+    enable: true to output the clock, false to disable it
+  Return
+    true if success, false if error
+*/
+bool AbraRTC::enableClkOut(bool enable) {
+	ABRA_TRACE_CALL(TRACE_CALL_ENABLE_CLKOUT, enable);
+
+	stageField<CTL1_CLKINT>(enable);
+
+	return commitConfig();
+}
+#endif
+
+#if ABRA_RTC_HAS_SET
+/*
+  Description
+    choose what begin() does when it finds the time was lost
+    call before begin()
+  Input
+    policy: RECOVER_* bits, RECOVER_DEFAULT resets the time and enables the trickle charger
+      0 leaves the time counting from midnight at power-on and skips the EEPROM check
+*/
+void AbraRTC::setRecoveryPolicy(uint8_t policy) {
+	ABRA_TRACE_CALL(TRACE_CALL_SET_RECOVERY_POLICY, policy);
+
+	recoveryPolicy = policy;
+}
+#endif
+
+#if ABRA_RTC_HAS_POWER_LOG
+/*
+  Description
+    record the current RTC time and date in user RAM so a later power event can
+    report how long the host was down, e.g. call once a minute
+  Return
+    true if success, false if error
+*/
+bool AbraRTC::logAlive() {
+	ABRA_TRACE_CALL(TRACE_CALL_LOG_ALIVE);
+
+	uint8_t aliveVals[4];
+	if (!readRegisters(SEC_ADDR, aliveVals, 4)) { return 0; }
+	for (uint8_t i = 0; i < 4; i++) {
+		aliveVals[i] |= POWER_LOG_BIT;
+	}
+
+	return writeRegisters(POWER_ALIVE_ADDR, aliveVals, 4);
+}
+
+/*
+  Description
+    get the power event found by begin(), or if it found none, read the last
+    one logged in user RAM, whose downtime is only known until logAlive() is
+    called after it
+  Input
+    event: last power event, flags are 0 if none was logged since the time was lost
+  Return
+    true if success, false if error
+*/
+bool AbraRTC::getPowerEvent(RTCPowerEvent &event) {
+	ABRA_TRACE_CALL(TRACE_CALL_GET_POWER_EVENT);
+
+	if (powerFlags) {
+		event = powerEvent;
+		return 1;
+	}
+
+	uint8_t logVals[8];
+	if (!readRegisters(POWER_EVENT_ADDR, logVals, 8)) { return 0; }
+	decodePowerLog(logVals, event);
+
+	return 1;
+}
+#endif
+
+
+#if ABRA_RTC_HAS_SET
+/*
+  Description
+    start a configuration transaction, discarding any uncommitted changes
+*/
+void AbraRTC::beginConfig() {
+	ABRA_TRACE_CALL(TRACE_CALL_BEGIN_CONFIG);
+
+	memset(&AbraRTCConfig, 0, sizeof(AbraRTCConfig));
+}
+
+/*
+  Description
+    stage the time of the RTC for commitConfig()
+    the hour is checked against the hour format when committed
+  Input
+    hour: hour to set to (1-12 for 12-hour format, 0-23 for 24-hour format)
+    min: minute to set to (0-59)
+    sec: second to set to (0-59)
+    PM: true for PM, false for AM
+  Return
+    true if success, false if min or sec is out of range
+*/
+bool AbraRTC::stageTime(uint8_t hour, uint8_t min, uint8_t sec, bool PM) {
+	ABRA_TRACE_CALL(TRACE_CALL_STAGE_TIME, hour, min, sec, PM);
+
+	if ((min >= 60) || (sec >= 60)) {
+		return 0;
+	}
+
+	AbraRTCConfig.timeStaged = 1;
+	AbraRTCConfig.hour   = hour;
+	AbraRTCConfig.PM     = PM;
+	AbraRTCConfig.minVal = MIN_1S::encode(min % 10) | MIN_10S::encode(min / 10);
+	AbraRTCConfig.secVal = SEC_1S::encode(sec % 10) | SEC_10S::encode(sec / 10);
+
+	return 1;
+}
+
+/*
+  Description
+    stage the hour format for commitConfig()
+    a time staged in the same transaction is interpreted in this format
+  Input
+    newHrFormat: true for 12-hour format, false for 24-hour format
+*/
+void AbraRTC::stageHrFormat(bool newHrFormat) {
+	ABRA_TRACE_CALL(TRACE_CALL_STAGE_HR_FORMAT, newHrFormat);
+
+	AbraRTCConfig.hrFormatStaged = 1;
+	AbraRTCConfig.hrFormat       = newHrFormat;
+	AbraRTCConfig.convertHour    = convertHrFormat; // only linked into sketches that change the format
+}
+
+/*
+  Description
+    stage bits of a control page or EEPROM control register for commitConfig()
+    in CTL_INT_FLAG_ADDR and CTL_STAT_ADDR a flag staged 0 is cleared, the
+    others are left as the RTC has them when committed
+  Input
+    addr: CTL_1_ADDR to CTL_RESET_ADDR, or EE_CTL_ADDR
+    mask: bits to change
+    val: new value of the masked bits
+*/
+void AbraRTC::stageBits(uint8_t addr, uint8_t mask, uint8_t val) {
+	ABRA_TRACE_CALL(TRACE_CALL_STAGE_BITS, addr, mask, val);
+
+	if (addr <= CTL_RESET_ADDR) {
+		uint8_t i = addr - CTL_1_ADDR;
+		AbraRTCConfig.ctlVals[i]  = (AbraRTCConfig.ctlVals[i] & ~mask) | (val & mask);
+		AbraRTCConfig.ctlMasks[i] |= mask;
+	} else if (addr == EE_CTL_ADDR) {
+		AbraRTCConfig.eeCtlVal  = (AbraRTCConfig.eeCtlVal & ~mask) | (val & mask);
+		AbraRTCConfig.eeCtlMask |= mask;
+	}
+}
+
+/*
+  Description
+    write all staged changes in as few bus transactions as possible
+      - staged control page registers are read and written back in bursts,
+        registers between them are rewritten with the value just read, except
+        the interrupt flag and status registers: those are never read back, a
+        burst doesn't cross them unless they are staged, and only their staged
+        flags are written 0
+      - sec, min and hour are written in one burst, the hour register is only
+        read when the hour format isn't staged along with the time
+      - EEPROM control is only written (with EEPROM refresh disabled) if it changes
+    nothing is written if the staged time is out of range
+  Return
+    true if success, false if error
+*/
+bool AbraRTC::commitConfig() {
+	ABRA_TRACE_CALL(TRACE_CALL_COMMIT_CONFIG);
+
+	// take the staged changes so the next transaction starts clean even on error
+	RTCConfig cfg = AbraRTCConfig;
+	memset(&AbraRTCConfig, 0, sizeof(AbraRTCConfig));
+
+#if ABRA_RTC_HAS_CONFIG
+	// check whether EEPROM control actually changes before paying for an EEPROM write
+	bool	EEWrite    = 0;
+	uint8_t newEECtlVal = 0;
+	bool	EERERestore = 1; // EEPROM refresh is enabled again after the write unless staged off
+	if (cfg.eeCtlMask) {
+		uint8_t EECtlVal = 0;
+		if (!readRegister(EE_CTL_ADDR, EECtlVal)) { return 0; }
+		newEECtlVal = (EECtlVal & ~cfg.eeCtlMask) | cfg.eeCtlVal;
+
+		if (newEECtlVal != EECtlVal) {
+			EEWrite = 1;
+			if (cfg.ctlMasks[0] & CTL1_EERE::mask) {
+				EERERestore = CTL1_EERE::get(cfg.ctlVals[0]);
+			}
+
+			// disable EEPROM refresh along with the other control page changes
+			cfg.ctlVals[0]  = CTL1_EERE::set(cfg.ctlVals[0], 0);
+			cfg.ctlMasks[0] |= CTL1_EERE::mask;
+		}
+	}
+#endif
+
+	// build sec, min, hour values before writing anything
+	uint8_t newTimeVals[3] = {cfg.secVal, cfg.minVal, 0};
+	uint8_t timeLen = 0; // number of time registers to write, ending at hour
+	if (cfg.timeStaged || cfg.hrFormatStaged) {
+		uint8_t RTCHourVal = 0;
+		if (!(cfg.timeStaged && cfg.hrFormatStaged)) { // need current hour format or hour
+			if (!readRegister(HOUR_ADDR, RTCHourVal)) { return 0; }
+		}
+
+		if (cfg.timeStaged) {
+			bool hrFormat = cfg.hrFormatStaged ? cfg.hrFormat : HOUR_FMT::get(RTCHourVal);
+			if (!encodeHour(cfg.hour, cfg.PM, hrFormat, newTimeVals[2])) { return 0; }
+			timeLen = 3;
+		} else if (HOUR_FMT::get(RTCHourVal) != cfg.hrFormat) {
+			newTimeVals[2] = cfg.convertHour(RTCHourVal, cfg.hrFormat);
+			timeLen = 1;
+		}
+	}
+
+	// control page, in bursts that don't cross an unstaged flag register
+#if ABRA_RTC_HAS_CONFIG
+	uint8_t ctl1Val = cfg.ctlVals[0];
+#endif
+	uint8_t ctlRegVals[sizeof(cfg.ctlMasks)] = {0};
+	uint8_t ctlFirst = 0;
+	while (ctlFirst < sizeof(cfg.ctlMasks)) {
+		if (!cfg.ctlMasks[ctlFirst]) {
+			ctlFirst++;
+			continue;
+		}
+
+		uint8_t ctlLast = ctlFirst;
+		for (uint8_t i = ctlFirst + 1; i < sizeof(cfg.ctlMasks); i++) {
+			if (cfg.ctlMasks[i]) {
+				ctlLast = i;
+			} else if (isFlagRegister(CTL_1_ADDR + i)) {
+				break;
+			}
+		}
+
+		// flag registers are never read back, a flag set since would be cleared by
+		// writing the old value, and registers that are entirely replaced needn't be
+		uint8_t readFirst = ctlLast + 1;
+		uint8_t readLast  = 0;
+		for (uint8_t i = ctlFirst; i <= ctlLast; i++) {
+			if (!isFlagRegister(CTL_1_ADDR + i) && (cfg.ctlMasks[i] != 0xFF)) {
+				if (readFirst > i) { readFirst = i; }
+				readLast = i;
+			}
+		}
+		if (readFirst <= readLast) {
+			if (!readRegisters(CTL_1_ADDR + readFirst, &ctlRegVals[readFirst], readLast - readFirst + 1)) { return 0; }
+		}
+
+		for (uint8_t i = ctlFirst; i <= ctlLast; i++) {
+			uint8_t mask = cfg.ctlMasks[i];
+			if (isFlagRegister(CTL_1_ADDR + i)) { // clear the staged flags only
+				ctlRegVals[i] = cfg.ctlVals[i] | ~mask;
+			} else {
+				ctlRegVals[i] = (ctlRegVals[i] & ~mask) | cfg.ctlVals[i];
+			}
+		}
+		if (!writeRegisters(CTL_1_ADDR + ctlFirst, &ctlRegVals[ctlFirst], ctlLast - ctlFirst + 1)) { return 0; }
+
+		ctlFirst = ctlLast + 1;
+	}
+#if ABRA_RTC_HAS_CONFIG
+	if (cfg.ctlMasks[0]) {
+		ctl1Val = ctlRegVals[0];
+	}
+#endif
+
+	// clock page
+	if (timeLen) {
+		if (!writeRegisters(HOUR_ADDR + 1 - timeLen, &newTimeVals[3 - timeLen], timeLen)) { return 0; }
+	}
+
+#if ABRA_RTC_HAS_CONFIG
+	// EEPROM control page
+	if (EEWrite) {
+		if (!writeEECtl(newEECtlVal, CTL1_EERE::set(ctl1Val, EERERestore))) { return 0; }
+	}
+#endif
 
 	return 1;
 }
+#endif
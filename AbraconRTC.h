@@ -2,18 +2,61 @@
 #define ABRACONRTC_H_
 
 #include <inttypes.h>
+#include "AbraconRTCRegs.h"
 
-// RTC I2C register addresses
-#define RTC_ADDR   	  0x56 // 7 bit, without least sig R/W bit
+// compile-time feature profiles, set ABRA_RTC_PROFILE (here or with -D) to strip unused code
+#define ABRA_RTC_PROFILE_READONLY 1 // begin(), updateRTC() and the time getters
+#define ABRA_RTC_PROFILE_DISPLAY  2 // adds temperature, setting and adjusting time and hour format,
+									// staged configuration and power-loss recovery (time reset only)
+#define ABRA_RTC_PROFILE_FULL	  3 // adds trickle charge (and its recovery), CLKOUT and the power event log
 
-// RTC addresses
-#define CTL_1_ADDR	  0x00 // control page register
-#define CTL_STAT_ADDR 0x03 // control status register
-#define SEC_ADDR   	  0x08 // seconds address
-#define MIN_ADDR   	  0x09 // minutes address
-#define HOUR_ADDR  	  0x0A // hours address
-#define TEMP_ADDR  	  0x20 // temperature address
-#define EE_CTL_ADDR   0x30 // EEPROM control address
+#ifndef ABRA_RTC_PROFILE
+#define ABRA_RTC_PROFILE ABRA_RTC_PROFILE_FULL
+#endif
+
+// individual features, each can also be overridden on its own
+#ifndef ABRA_RTC_HAS_TEMP
+#define ABRA_RTC_HAS_TEMP (ABRA_RTC_PROFILE >= ABRA_RTC_PROFILE_DISPLAY)
+#endif
+#ifndef ABRA_RTC_HAS_SET
+#define ABRA_RTC_HAS_SET (ABRA_RTC_PROFILE >= ABRA_RTC_PROFILE_DISPLAY)
+#endif
+#ifndef ABRA_RTC_HAS_CONFIG
+#define ABRA_RTC_HAS_CONFIG (ABRA_RTC_PROFILE >= ABRA_RTC_PROFILE_FULL)
+#endif
+#ifndef ABRA_RTC_HAS_POWER_LOG
+#define ABRA_RTC_HAS_POWER_LOG (ABRA_RTC_PROFILE >= ABRA_RTC_PROFILE_FULL)
+#endif
+
+#if ABRA_RTC_HAS_CONFIG && !ABRA_RTC_HAS_SET
+#error "ABRA_RTC_HAS_CONFIG needs ABRA_RTC_HAS_SET"
+#endif
+
+// power event flags, see getPowerFlags() and RTCPowerEvent
+#define POWER_PON	 0x01 // power-on reset, time and RAM were lost
+#define POWER_SR	 0x02 // self-recovery reset
+#define POWER_LOW_V1 0x04 // supply dropped below V_LOW1, ran from backup without temperature compensation
+#define POWER_LOW_V2 0x08 // supply dropped below V_LOW2, time may be corrupt
+
+// recovery policy bits, see setRecoveryPolicy()
+#define RECOVER_SET_TIME  0x01 // reset time to midnight after the time was lost
+#define RECOVER_TRICKLE   0x02 // make sure the trickle charger is enabled after the time was lost
+#define RECOVER_ON_LOW_V2 0x04 // treat POWER_LOW_V2 as the time being lost, like POWER_PON
+#define RECOVER_DEFAULT	  (RECOVER_SET_TIME | RECOVER_TRICKLE)
+
+// power event log in RTC user RAM, each entry is the sec, min, hour and date
+// register values, with bit 7 (unused by those registers) marking the entry
+#define POWER_EVENT_ADDR RAM_ADDR		// time found, bit 7 of byte n is power flag bit n
+#define POWER_ALIVE_ADDR (RAM_ADDR + 4) // last logAlive() time, bit 7 of every byte set
+#define POWER_LOG_BIT	 0x80
+
+struct RTCPowerEvent {
+	uint8_t  flags;		   // POWER_* flags found by begin()
+	uint32_t secOfDay;	   // RTC time when begin() found the flags, before any recovery
+	bool	 aliveValid;   // true if logAlive() was called since the last time loss
+	uint32_t aliveSecOfDay; // last logAlive() time before the event
+	int32_t  downSeconds;  // seconds from last logAlive() to the event, -1 if unknown or not on the same date
+};
 
 struct RTCData {
 	bool 	hrFormat; // true for 12-hour format, false for 24-hour format
@@ -24,22 +67,62 @@ struct RTCData {
 	uint8_t min1s;
 	uint8_t sec10s;
 	uint8_t sec1s;
+#if ABRA_RTC_HAS_TEMP
 	uint8_t tempF;
+#endif
+};
+
+// changes staged by the stage*() methods, written by commitConfig()
+struct RTCConfig {
+	uint8_t ctlVals[CTL_RESET_ADDR - CTL_1_ADDR + 1];  // staged control page bits
+	uint8_t ctlMasks[CTL_RESET_ADDR - CTL_1_ADDR + 1]; // which control page bits are staged
+	uint8_t eeCtlVal;  // staged EEPROM control bits
+	uint8_t eeCtlMask; // which EEPROM control bits are staged
+	bool	timeStaged;
+	uint8_t hour; // as passed to stageTime(), encoded once the hour format is known
+	bool	PM;
+	uint8_t minVal; // minutes register value
+	uint8_t secVal; // seconds register value
+	bool	hrFormatStaged;
+	bool	hrFormat; // true for 12-hour format, false for 24-hour format
+	uint8_t (*convertHour)(uint8_t RTCHourVal, bool newHrFormat); // set along with hrFormat
 };
 
 
 class AbraRTC {
 	private:
 		static RTCData AbraRTCData;
+#if ABRA_RTC_HAS_SET
+		static RTCConfig AbraRTCConfig;
+		static uint8_t recoveryPolicy;
+#endif
+		static uint8_t powerFlags;
+#if ABRA_RTC_HAS_POWER_LOG
+		static RTCPowerEvent powerEvent; // found by begin()
+#endif
 
+		static bool writeRegisters(uint8_t addr, const uint8_t *vals, uint8_t len);
+		static bool readRegisters(uint8_t addr, uint8_t *vals, uint8_t len);
 		static bool writeRegister(uint8_t addr, uint8_t val);
-		static bool selectRegister(uint8_t addr);
 		static bool readRegister(uint8_t addr, uint8_t &readVal);
-		static bool writeBit(uint8_t addr, uint8_t bitPosition, bool val);
 
+		// flags in these are set by the RTC, cleared by writing 0 and left as they are by writing 1
+		static bool isFlagRegister(uint8_t addr) { return (addr == CTL_INT_FLAG_ADDR) || (addr == CTL_STAT_ADDR); }
+
+#if ABRA_RTC_HAS_SET
 		static uint8_t hour12to24(uint8_t RTCHourTimeOfDay, uint8_t RTCHourVal1s, uint8_t RTCHourVal10s);
 		static uint8_t hour24to12(uint8_t RTCHourVal1s, uint8_t RTCHourVal10s);
+		static uint8_t convertHrFormat(uint8_t RTCHourVal, bool newHrFormat);
+		static bool encodeHour(uint8_t hour, bool PM, bool hrFormat, uint8_t &hourVal);
+#endif
+#if ABRA_RTC_HAS_CONFIG
 		static bool checkEEPROMBusy();
+		static bool writeEECtl(uint8_t EECtlVal, uint8_t ctl1Val);
+#endif
+#if ABRA_RTC_HAS_POWER_LOG
+		static uint32_t timeToSecOfDay(const uint8_t *timeVals);
+		static void decodePowerLog(const uint8_t *logVals, RTCPowerEvent &event);
+#endif
 	public:
 		AbraRTC();
 		bool begin();
@@ -53,16 +136,93 @@ class AbraRTC {
 		uint8_t getMin10s() { return AbraRTCData.min10s; }
 		uint8_t getSec1s() { return AbraRTCData.sec1s; }
 		uint8_t getSec10s() { return AbraRTCData.sec10s; }
+#if ABRA_RTC_HAS_TEMP
 		uint8_t getTempF() { return AbraRTCData.tempF; }
+#endif
+		uint32_t getSecOfDay();
+		uint8_t getPowerFlags() { return powerFlags; }
 
+		static bool readBits(uint8_t addr, uint8_t mask, uint8_t &val);
+		static bool writeBits(uint8_t addr, uint8_t mask, uint8_t val);
+
+#if ABRA_RTC_HAS_POWER_LOG
+		static bool logAlive();
+		static bool getPowerEvent(RTCPowerEvent &event);
+#endif
+
+#if ABRA_RTC_HAS_SET
+		static void setRecoveryPolicy(uint8_t policy);
 		bool setTime(uint8_t hour=0, uint8_t min=0, uint8_t sec=0, bool PM=0);
-		bool setTrickleCharge(bool enable);
 		bool setHrFormat(bool newHrFormat);
 		static bool toggleHrFormat();
 		static bool incHour();
 		static bool decHour();
 		static bool incMin();
 		static bool decMin();
+#endif
+
+#if ABRA_RTC_HAS_CONFIG
+		bool setTrickleCharge(bool enable);
+		static bool setClkOut(uint8_t freq);
+		static bool enableClkOut(bool enable);
+		static void stageTrickleCharge(bool enableTC) { stageField<AbraReg::EECTL_R1K>(enableTC); }
+#endif
+
+#if ABRA_RTC_HAS_SET
+		static void beginConfig();
+		static bool stageTime(uint8_t hour=0, uint8_t min=0, uint8_t sec=0, bool PM=0);
+		static void stageHrFormat(bool newHrFormat);
+		static void stageBits(uint8_t addr, uint8_t mask, uint8_t val);
+		static bool commitConfig();
+
+		/*
+		  Description
+		    stage one or more control page or EEPROM control fields for commitConfig(),
+		    e.g. stageField<AbraReg::STAT_PON>(0)
+		  Input
+		    vals: one value per field, unshifted
+		*/
+		template <class... Fs>
+		static void stageField(typename AbraReg::Value<Fs>::type... vals) {
+			typedef AbraReg::Fields<Fs...> Set;
+			static_assert((Set::addr <= CTL_RESET_ADDR) || (Set::addr == EE_CTL_ADDR),
+				"only control page and EEPROM control fields can be staged");
+			stageBits(Set::addr, Set::mask, Set::encode(vals...));
+		}
+#endif
+
+		/*
+		  Description
+		    read a register field, e.g. readField<AbraReg::STAT_PON>(val)
+		  Input
+		    val: field value read, shifted down to bit 0
+		  Return
+		    true if success, false if error
+		*/
+		template <class F>
+		static bool readField(uint8_t &val) {
+			uint8_t regVal = 0;
+			if (!readBits(F::addr, F::mask, regVal)) { return 0; }
+			val = F::get(regVal);
+			return 1;
+		}
+
+		/*
+		  Description
+		    write one or more fields of the same register in a single write,
+		    e.g. writeField<AbraReg::CTL1_WE, AbraReg::CTL1_CLKINT>(1, 1)
+		    the register is only read first if the fields don't cover all 8 bits,
+		    in the interrupt flag and status registers other flags are left alone
+		  Input
+		    vals: one value per field, unshifted
+		  Return
+		    true if success, false if error
+		*/
+		template <class... Fs>
+		static bool writeField(typename AbraReg::Value<Fs>::type... vals) {
+			typedef AbraReg::Fields<Fs...> Set;
+			return writeBits(Set::addr, Set::mask, Set::encode(vals...));
+		}
 };
 
 extern AbraRTC RTC;
@@ -0,0 +1,147 @@
+#include <Arduino.h>
+#include "AbraconRTCClock.h"
+
+// Initialize Class Variables //////////////////////////////////////////////////
+
+volatile uint32_t AbraClock::secondCount  = 0;
+volatile uint16_t AbraClock::secondEdges  = 0;
+volatile uint32_t AbraClock::edgeMicros   = 0;
+volatile uint32_t AbraClock::secondMicros = 0;
+volatile int32_t  AbraClock::hostPpm8     = 0;
+uint16_t AbraClock::edgeHz = 0;
+
+// Public Methods //////////////////////////////////////////////////////////////
+
+/*
+  Description
+    start counting CLKOUT edges on an interrupt pin
+    CLKOUT must already be set to clkOutFreq and enabled
+  Input
+    pin: host pin wired to CLKOUT, must support attachInterrupt()
+    clkOutFreq: CLKOUT_1024HZ, CLKOUT_32HZ or CLKOUT_1HZ
+      (32.768 kHz is too fast to count with interrupts)
+  Return
+    true if success, false if error
+*/
+bool AbraClock::begin(uint8_t pin, uint8_t clkOutFreq) {
+	switch (clkOutFreq) {
+		case CLKOUT_1024HZ: edgeHz = 1024; break;
+		case CLKOUT_32HZ:	edgeHz = 32;   break;
+		case CLKOUT_1HZ:	edgeHz = 1;    break;
+		default:			return 0;
+	}
+
+	int interrupt = digitalPinToInterrupt(pin);
+	if (interrupt < 0) {
+		return 0;
+	}
+
+	noInterrupts();
+	secondCount  = 0;
+	secondEdges  = 0;
+	edgeMicros   = micros();
+	secondMicros = edgeMicros;
+	hostPpm8     = 0;
+	interrupts();
+
+	pinMode(pin, INPUT);
+	attachInterrupt(interrupt, onEdge, RISING);
+
+	return 1;
+}
+
+/*
+  Description
+    stop counting CLKOUT edges
+  Input
+    pin: host pin passed to begin()
+*/
+void AbraClock::end(uint8_t pin) {
+	detachInterrupt(digitalPinToInterrupt(pin));
+}
+
+/*
+  Description
+    count a rising CLKOUT edge, called from the pin interrupt
+    once per RTC second the host timer error is measured against the RTC
+*/
+void AbraClock::onEdge() {
+	uint32_t now = micros();
+	edgeMicros = now;
+
+	if (++secondEdges == edgeHz) {
+		secondEdges = 0;
+		secondCount++;
+
+		// host microseconds per RTC second minus 1000000 is the error in ppm
+		int32_t error = (int32_t)(now - secondMicros) - 1000000L;
+		secondMicros = now;
+		if (secondCount == 1) { // first second started at begin(), not on an edge
+			return;
+		}
+		// kept times 8 so the average settles on the error instead of truncating short of it
+		hostPpm8 += error - (hostPpm8 / 8);
+	}
+}
+
+/*
+  Description
+    milliseconds since begin(), counted by the RTC crystal
+    the host timer only interpolates within one CLKOUT period, so the value
+    never runs ahead of the next edge and never goes backwards
+  Return
+    RTC disciplined milliseconds, or host milliseconds if begin() wasn't called
+    wraps at 2^32 like ::millis()
+*/
+uint32_t AbraClock::millis() {
+	if (!edgeHz) {
+		return ::millis();
+	}
+
+	noInterrupts();
+	uint32_t secs  = secondCount;
+	uint16_t edges = secondEdges;
+	uint32_t since = micros() - edgeMicros;
+	interrupts();
+
+	uint32_t periodMicros = 1000000UL / edgeHz;
+	if (since > periodMicros) {
+		since = periodMicros;
+	}
+
+	uint32_t micro = edges * 1000000UL / edgeHz + since;
+
+	return (secs * 1000UL) + (micro / 1000UL);
+}
+
+/*
+  Description
+    whole seconds since begin(), counted by the RTC crystal
+  Return
+    RTC disciplined seconds, or host seconds if begin() wasn't called
+*/
+uint32_t AbraClock::seconds() {
+	if (!edgeHz) {
+		return ::millis() / 1000UL;
+	}
+
+	noInterrupts();
+	uint32_t secs = secondCount;
+	interrupts();
+
+	return secs;
+}
+
+/*
+  Description
+    error of the host timer measured against the RTC, filtered over several seconds
+  Return
+    parts per million, positive if the host timer runs fast
+*/
+int32_t AbraClock::driftPpm() {
+	noInterrupts();
+	int32_t ppm8 = hostPpm8;
+	interrupts();
+
+	return ppm8 / 8;
+}
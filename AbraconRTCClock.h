@@ -0,0 +1,37 @@
+#ifndef ABRACONRTCCLOCK_H_
+#define ABRACONRTCCLOCK_H_
+
+#include <inttypes.h>
+#include "AbraconRTCRegs.h"
+
+/*
+  Millisecond clock disciplined by the RTC CLKOUT signal
+
+  The RTC crystal sets the long term rate, the host timer only interpolates
+  between CLKOUT edges, so scheduling on AbraClock::millis() keeps the RTC's
+  accuracy over long uptimes instead of drifting with the host resonator.
+
+  Usage:
+    RTC.setClkOut(CLKOUT_32HZ);
+    RTC.enableClkOut(1);
+    AbraClock::begin(2, CLKOUT_32HZ); // CLKOUT wired to interrupt capable pin 2
+*/
+class AbraClock {
+	private:
+		static volatile uint32_t secondCount; // whole RTC seconds since begin()
+		static volatile uint16_t secondEdges; // CLKOUT edges since the last whole RTC second
+		static volatile uint32_t edgeMicros;  // host micros() at the last edge
+		static volatile uint32_t secondMicros; // host micros() at the last whole RTC second
+		static volatile int32_t  hostPpm8;    // filtered host timer error, times 8
+		static uint16_t edgeHz;
+	public:
+		static bool begin(uint8_t pin, uint8_t clkOutFreq);
+		static void end(uint8_t pin);
+		static void onEdge();
+
+		static uint32_t millis();
+		static uint32_t seconds();
+		static int32_t driftPpm();
+};
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef ABRACONRTCREGS_H_
+#define ABRACONRTCREGS_H_
+
+#include <inttypes.h>
+
+// RTC I2C register addresses
+#define RTC_ADDR   	  0x56 // 7 bit, without least sig R/W bit
+
+// RTC addresses
+// control page
+#define CTL_1_ADDR	  	  0x00 // control page register
+#define CTL_INT_ADDR	  0x01 // interrupt enable register
+#define CTL_INT_FLAG_ADDR 0x02 // interrupt flag register
+#define CTL_STAT_ADDR 	  0x03 // control status register
+#define CTL_RESET_ADDR	  0x04 // system reset register
+
+// clock page
+#define SEC_ADDR   	  0x08 // seconds address
+#define MIN_ADDR   	  0x09 // minutes address
+#define HOUR_ADDR  	  0x0A // hours address
+#define DATE_ADDR  	  0x0B // day of month address
+#define WEEKDAY_ADDR  0x0C // day of week address
+#define MONTH_ADDR 	  0x0D // month address
+#define YEAR_ADDR  	  0x0E // year address
+
+// alarm page
+#define ALARM_SEC_ADDR	   0x10 // seconds alarm address
+#define ALARM_MIN_ADDR	   0x11 // minutes alarm address
+#define ALARM_HOUR_ADDR	   0x12 // hours alarm address
+#define ALARM_DATE_ADDR	   0x13 // day of month alarm address
+#define ALARM_WEEKDAY_ADDR 0x14 // day of week alarm address
+#define ALARM_MONTH_ADDR   0x15 // month alarm address
+#define ALARM_YEAR_ADDR	   0x16 // year alarm address
+
+// timer page
+#define TIMER_LOW_ADDR	  0x18 // countdown timer low byte address
+#define TIMER_HIGH_ADDR	  0x19 // countdown timer high byte address
+
+// temperature page
+#define TEMP_ADDR  	  0x20 // temperature address
+
+// EEPROM user page
+#define EE_USER_ADDR  0x28 // first of 2 user EEPROM bytes
+
+// EEPROM control page
+#define EE_CTL_ADDR   	 0x30 // EEPROM control address
+#define XTAL_OFFSET_ADDR 0x31 // crystal frequency offset address
+#define XTAL_COEF_ADDR	 0x32 // crystal temperature coefficient address
+#define XTAL_T0_ADDR	 0x33 // crystal turnover temperature address
+
+// CLKOUT frequencies for EECTL_FD
+#define CLKOUT_32768HZ 0
+#define CLKOUT_1024HZ  1
+#define CLKOUT_32HZ	   2
+#define CLKOUT_1HZ	   3
+
+// RAM page
+#define RAM_ADDR   	  0x38 // first of 8 user RAM bytes
+#define RAM_SIZE   	  8
+
+/*
+  Register fields
+
+  Each field is a type carrying its register address, shift and mask so that
+  the accessors in AbraRTC resolve to a single constant shift/mask at compile
+  time. Fields in the same register can be combined with Fields<> and
+  written together in one register write.
+*/
+namespace AbraReg {
+
+template <uint8_t Addr, uint8_t Shift, uint8_t Width>
+struct Field {
+	static constexpr uint8_t addr  = Addr;
+	static constexpr uint8_t shift = Shift;
+	static constexpr uint8_t mask  = (uint8_t)(((1 << Width) - 1) << Shift);
+
+	// extract field value from a register value
+	static constexpr uint8_t get(uint8_t regVal) { return (regVal & mask) >> shift; }
+	// place field value at its register position
+	static constexpr uint8_t encode(uint8_t val) { return (uint8_t)(val << shift) & mask; }
+	// replace field value within a register value
+	static constexpr uint8_t set(uint8_t regVal, uint8_t val) { return (regVal & ~mask) | encode(val); }
+};
+
+// several fields of the same register, written together
+template <class F, class... Fs>
+struct Fields {
+	static_assert(F::addr == Fields<Fs...>::addr, "fields must be in the same register");
+
+	static constexpr uint8_t addr = F::addr;
+	static constexpr uint8_t mask = F::mask | Fields<Fs...>::mask;
+
+	template <class... Vs>
+	static constexpr uint8_t encode(uint8_t val, Vs... vals) { return F::encode(val) | Fields<Fs...>::encode(vals...); }
+};
+
+template <class F>
+struct Fields<F> {
+	static constexpr uint8_t addr = F::addr;
+	static constexpr uint8_t mask = F::mask;
+
+	static constexpr uint8_t encode(uint8_t val) { return F::encode(val); }
+};
+
+// one value per field for the accessor parameter lists
+template <class F>
+struct Value { typedef uint8_t type; };
+
+// control page
+typedef Field<CTL_1_ADDR, 0, 1> CTL1_WE;     // 1 Hz watch (clock) enable
+typedef Field<CTL_1_ADDR, 1, 1> CTL1_TE;     // countdown timer enable
+typedef Field<CTL_1_ADDR, 2, 1> CTL1_TAR;    // countdown timer auto-reload
+typedef Field<CTL_1_ADDR, 3, 1> CTL1_EERE;   // EEPROM refresh enable
+typedef Field<CTL_1_ADDR, 4, 1> CTL1_SROn;   // self-recovery enable
+typedef Field<CTL_1_ADDR, 5, 2> CTL1_TD;     // countdown timer source clock
+typedef Field<CTL_1_ADDR, 7, 1> CTL1_CLKINT; // CLKOUT enable (CLKOE pin must also be high)
+
+typedef Field<CTL_INT_ADDR, 0, 1> INT_AIE;   // alarm interrupt enable
+typedef Field<CTL_INT_ADDR, 1, 1> INT_TIE;   // timer interrupt enable
+typedef Field<CTL_INT_ADDR, 2, 1> INT_V1IE;  // low voltage 1 interrupt enable
+typedef Field<CTL_INT_ADDR, 3, 1> INT_V2IE;  // low voltage 2 interrupt enable
+typedef Field<CTL_INT_ADDR, 4, 1> INT_SRIE;  // self-recovery interrupt enable
+
+typedef Field<CTL_INT_FLAG_ADDR, 0, 1> INTF_AF;   // alarm flag
+typedef Field<CTL_INT_FLAG_ADDR, 1, 1> INTF_TF;   // timer flag
+typedef Field<CTL_INT_FLAG_ADDR, 2, 1> INTF_V1IF; // low voltage 1 interrupt flag
+typedef Field<CTL_INT_FLAG_ADDR, 3, 1> INTF_V2IF; // low voltage 2 interrupt flag
+typedef Field<CTL_INT_FLAG_ADDR, 4, 1> INTF_SRF;  // self-recovery interrupt flag
+
+typedef Field<CTL_STAT_ADDR, 2, 1> STAT_V1F;    // low voltage 1 (temp compensation stopped)
+typedef Field<CTL_STAT_ADDR, 3, 1> STAT_V2F;    // low voltage 2 (clock data may be corrupt)
+typedef Field<CTL_STAT_ADDR, 4, 1> STAT_SR;     // self-recovery reset occurred
+typedef Field<CTL_STAT_ADDR, 5, 1> STAT_PON;    // power-on reset occurred
+typedef Field<CTL_STAT_ADDR, 7, 1> STAT_EEBUSY; // EEPROM busy (read only)
+
+typedef Field<CTL_RESET_ADDR, 4, 1> RESET_SYSR; // system reset
+
+// clock page
+typedef Field<SEC_ADDR, 0, 4> SEC_1S;
+typedef Field<SEC_ADDR, 4, 3> SEC_10S;
+typedef Field<MIN_ADDR, 0, 4> MIN_1S;
+typedef Field<MIN_ADDR, 4, 3> MIN_10S;
+typedef Field<HOUR_ADDR, 0, 4> HOUR_1S;
+typedef Field<HOUR_ADDR, 4, 1> HOUR_10S_12; // ten's digit in 12-hour format
+typedef Field<HOUR_ADDR, 4, 2> HOUR_10S_24; // ten's digit in 24-hour format
+typedef Field<HOUR_ADDR, 5, 1> HOUR_PM;     // true for PM in 12-hour format
+typedef Field<HOUR_ADDR, 6, 1> HOUR_FMT;    // true for 12-hour, false for 24-hour
+typedef Field<DATE_ADDR, 0, 4> DATE_1S;
+typedef Field<DATE_ADDR, 4, 2> DATE_10S;
+typedef Field<WEEKDAY_ADDR, 0, 3> WEEKDAY;
+typedef Field<MONTH_ADDR, 0, 4> MONTH_1S;
+typedef Field<MONTH_ADDR, 4, 1> MONTH_10S;
+typedef Field<YEAR_ADDR, 0, 4> YEAR_1S;
+typedef Field<YEAR_ADDR, 4, 3> YEAR_10S;
+
+// alarm page, same digit layout as the clock page plus an enable bit per register
+typedef Field<ALARM_SEC_ADDR, 0, 4> ALARM_SEC_1S;
+typedef Field<ALARM_SEC_ADDR, 4, 3> ALARM_SEC_10S;
+typedef Field<ALARM_SEC_ADDR, 7, 1> ALARM_SEC_AE;
+typedef Field<ALARM_MIN_ADDR, 0, 4> ALARM_MIN_1S;
+typedef Field<ALARM_MIN_ADDR, 4, 3> ALARM_MIN_10S;
+typedef Field<ALARM_MIN_ADDR, 7, 1> ALARM_MIN_AE;
+typedef Field<ALARM_HOUR_ADDR, 0, 4> ALARM_HOUR_1S;
+typedef Field<ALARM_HOUR_ADDR, 4, 1> ALARM_HOUR_10S_12; // ten's digit in 12-hour format (set by HOUR_FMT)
+typedef Field<ALARM_HOUR_ADDR, 4, 2> ALARM_HOUR_10S_24; // ten's digit in 24-hour format
+typedef Field<ALARM_HOUR_ADDR, 5, 1> ALARM_HOUR_PM;     // true for PM in 12-hour format
+typedef Field<ALARM_HOUR_ADDR, 7, 1> ALARM_HOUR_AE;
+typedef Field<ALARM_DATE_ADDR, 0, 4> ALARM_DATE_1S;
+typedef Field<ALARM_DATE_ADDR, 4, 2> ALARM_DATE_10S;
+typedef Field<ALARM_DATE_ADDR, 7, 1> ALARM_DATE_AE;
+typedef Field<ALARM_WEEKDAY_ADDR, 0, 3> ALARM_WEEKDAY;
+typedef Field<ALARM_WEEKDAY_ADDR, 7, 1> ALARM_WEEKDAY_AE;
+typedef Field<ALARM_MONTH_ADDR, 0, 4> ALARM_MONTH_1S;
+typedef Field<ALARM_MONTH_ADDR, 4, 1> ALARM_MONTH_10S;
+typedef Field<ALARM_MONTH_ADDR, 7, 1> ALARM_MONTH_AE;
+typedef Field<ALARM_YEAR_ADDR, 0, 4> ALARM_YEAR_1S;
+typedef Field<ALARM_YEAR_ADDR, 4, 3> ALARM_YEAR_10S;
+typedef Field<ALARM_YEAR_ADDR, 7, 1> ALARM_YEAR_AE;
+
+// timer page, 16 bit countdown value split over two registers
+typedef Field<TIMER_LOW_ADDR, 0, 8> TIMER_LOW;
+typedef Field<TIMER_HIGH_ADDR, 0, 8> TIMER_HIGH;
+
+// temperature page, degrees C offset by 60
+typedef Field<TEMP_ADDR, 0, 8> TEMP;
+
+// EEPROM user page
+typedef Field<EE_USER_ADDR, 0, 8> EE_USER_0;
+typedef Field<EE_USER_ADDR + 1, 0, 8> EE_USER_1;
+
+// EEPROM control page
+typedef Field<EE_CTL_ADDR, 0, 1> EECTL_ThP;  // thermometer scan period (1 = 1 s, 0 = 16 s)
+typedef Field<EE_CTL_ADDR, 1, 1> EECTL_ThE;  // thermometer enable
+typedef Field<EE_CTL_ADDR, 2, 2> EECTL_FD;   // CLKOUT frequency select
+typedef Field<EE_CTL_ADDR, 4, 1> EECTL_R1K;  // 1.5k Ohm trickle charge resistor
+typedef Field<EE_CTL_ADDR, 5, 1> EECTL_R5K;  // 5k Ohm trickle charge resistor
+typedef Field<EE_CTL_ADDR, 6, 1> EECTL_R20K; // 20k Ohm trickle charge resistor
+typedef Field<EE_CTL_ADDR, 7, 1> EECTL_R80K; // 80k Ohm trickle charge resistor
+
+typedef Field<XTAL_OFFSET_ADDR, 0, 7> XTAL_OFFSET;      // frequency offset magnitude
+typedef Field<XTAL_OFFSET_ADDR, 7, 1> XTAL_OFFSET_SIGN; // true for negative offset
+typedef Field<XTAL_COEF_ADDR, 0, 8> XTAL_COEF;
+typedef Field<XTAL_T0_ADDR, 0, 6> XTAL_T0;
+
+// RAM page, one field per byte, e.g. RAM_BYTE<3>
+template <uint8_t N>
+struct RAM_BYTE : Field<RAM_ADDR + N, 0, 8> {
+	static_assert(N < RAM_SIZE, "RAM has only RAM_SIZE bytes");
+};
+
+}
+
+#endif
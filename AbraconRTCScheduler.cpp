@@ -0,0 +1,252 @@
+#include <Arduino.h>
+#include "AbraconRTCScheduler.h"
+
+// Initialize Class Variables //////////////////////////////////////////////////
+
+AbraSchedJob AbraSched::jobs[ABRA_SCHED_MAX_JOBS];
+uint8_t  AbraSched::jobCount  = 0;
+uint32_t AbraSched::now       = 0;
+uint32_t AbraSched::dayOffset = 0;
+bool	 AbraSched::synced    = 0;
+volatile uint8_t AbraSched::pendingTicks = 0;
+
+// true if job a is due before job b, allowing for the seconds counter wrapping
+#define DUE_BEFORE(a, b) ((int32_t)((a).due - (b).due) < 0)
+
+// Private Methods /////////////////////////////////////////////////////////////
+
+/*
+  Description
+    when a job is first due, counted from the current time
+  Input
+    entry: job to schedule
+  Return
+    scheduler seconds when the job is due
+*/
+uint32_t AbraSched::firstDue(const AbraSchedJob &entry) {
+	uint32_t sod = secOfDay();
+
+	switch (entry.kind) {
+		case SCHED_ALIGNED:
+			return now + ((entry.period - (sod % entry.period)) % entry.period);
+		case SCHED_DAILY:
+			return now + ((entry.at + SCHED_SECONDS_PER_DAY - sod) % SCHED_SECONDS_PER_DAY);
+	}
+	return now + entry.period;
+}
+
+/*
+  Description
+    move a job towards the top of the heap until its parent is due first
+  Input
+    i: heap index of the job
+*/
+void AbraSched::siftUp(uint8_t i) {
+	while (i > 0) {
+		uint8_t parent = (i - 1) / 2;
+		if (!DUE_BEFORE(jobs[i], jobs[parent])) {
+			break;
+		}
+		AbraSchedJob swap = jobs[i];
+		jobs[i]      = jobs[parent];
+		jobs[parent] = swap;
+		i = parent;
+	}
+}
+
+/*
+  Description
+    move a job towards the bottom of the heap until its children are due after it
+  Input
+    i: heap index of the job
+*/
+void AbraSched::siftDown(uint8_t i) {
+	while (1) {
+		uint8_t first = i;
+		uint8_t left  = 2 * i + 1;
+		uint8_t right = left + 1;
+		if ((left < jobCount) && DUE_BEFORE(jobs[left], jobs[first])) {
+			first = left;
+		}
+		if ((right < jobCount) && DUE_BEFORE(jobs[right], jobs[first])) {
+			first = right;
+		}
+		if (first == i) {
+			break;
+		}
+		AbraSchedJob swap = jobs[i];
+		jobs[i]     = jobs[first];
+		jobs[first] = swap;
+		i = first;
+	}
+}
+
+/*
+  Description
+    schedule and insert a job into the heap
+  Input
+    entry: job to add, due is filled in
+  Return
+    true if success, false if all ABRA_SCHED_MAX_JOBS slots are used
+*/
+bool AbraSched::add(AbraSchedJob &entry) {
+	if (jobCount >= ABRA_SCHED_MAX_JOBS) {
+		return 0;
+	}
+
+	entry.due = firstDue(entry);
+	jobs[jobCount] = entry;
+	siftUp(jobCount++);
+
+	return 1;
+}
+
+/*
+  Description
+    reschedule wall clock jobs after the clock was set, then rebuild the heap
+*/
+void AbraSched::realign() {
+	for (uint8_t i = 0; i < jobCount; i++) {
+		if (jobs[i].kind != SCHED_EVERY) {
+			jobs[i].due = firstDue(jobs[i]);
+		}
+	}
+	for (uint8_t i = jobCount / 2; i > 0; i--) {
+		siftDown(i - 1);
+	}
+}
+
+// Public Methods //////////////////////////////////////////////////////////////
+
+/*
+  Description
+    remove all jobs
+*/
+void AbraSched::clear() {
+	jobCount = 0;
+}
+
+/*
+  Description
+    register a job to run every period seconds
+  Input
+    period: seconds between runs
+    job: function to call
+    aligned: true to run on multiples of period on the clock (e.g. 60 on the minute),
+      false to count from now, aligned jobs need sync() to have been called
+  Return
+    true if success, false if error, no free job slots or aligned before sync()
+*/
+bool AbraSched::every(uint32_t period, AbraJob job, bool aligned) {
+	if (!period || !job || (aligned && !synced)) {
+		return 0;
+	}
+
+	AbraSchedJob entry = {0};
+	entry.period = period;
+	entry.kind   = aligned ? SCHED_ALIGNED : SCHED_EVERY;
+	entry.job    = job;
+
+	return add(entry);
+}
+
+/*
+  Description
+    register a job to run once a day at a wall clock time
+    sync() must have been called first, the scheduler doesn't know the time before
+  Input
+    hour: hour to run at (0-23)
+    min: minute to run at (0-59)
+    sec: second to run at (0-59)
+    job: function to call
+  Return
+    true if success, false if error, no free job slots or before sync()
+*/
+bool AbraSched::daily(uint8_t hour, uint8_t min, uint8_t sec, AbraJob job) {
+	if ((hour >= 24) || (min >= 60) || (sec >= 60) || !job || !synced) {
+		return 0;
+	}
+
+	AbraSchedJob entry = {0};
+	entry.period = SCHED_SECONDS_PER_DAY;
+	entry.at     = (hour * 3600UL) + (min * 60UL) + sec;
+	entry.kind   = SCHED_DAILY;
+	entry.job    = job;
+
+	return add(entry);
+}
+
+/*
+  Description
+    count one second, safe to call from the RTC 1 Hz CLKOUT interrupt
+    the second is applied by the next run()
+*/
+void AbraSched::tick() {
+	if (pendingTicks < 0xFF) {
+		pendingTicks++;
+	}
+}
+
+/*
+  Description
+    advance to the RTC's second of the day, for driving the scheduler by change detection
+    the first call, or a jump larger than ABRA_SCHED_MAX_STEP (the clock was set),
+    aligns the scheduler to the clock and reschedules wall clock jobs without running them
+  Input
+    secOfDay: seconds since midnight, e.g. RTC.getSecOfDay()
+*/
+void AbraSched::sync(uint32_t secOfDay) {
+	// the RTC time already includes any seconds ticked since the last run()
+	noInterrupts();
+	pendingTicks = 0;
+	interrupts();
+
+	uint32_t step = (secOfDay + SCHED_SECONDS_PER_DAY - AbraSched::secOfDay()) % SCHED_SECONDS_PER_DAY;
+
+	if (synced && (step <= ABRA_SCHED_MAX_STEP)) {
+		advance(step);
+		return;
+	}
+
+	dayOffset = (secOfDay + SCHED_SECONDS_PER_DAY - (now % SCHED_SECONDS_PER_DAY)) % SCHED_SECONDS_PER_DAY;
+	synced = 1;
+	realign();
+}
+
+/*
+  Description
+    count elapsed seconds, for driving the scheduler from another time source
+  Input
+    secs: seconds elapsed
+*/
+void AbraSched::advance(uint32_t secs) {
+	now += secs;
+}
+
+/*
+  Description
+    run every job that is due, each at most once, and schedule its next run
+    runs that were missed while the scheduler wasn't called are skipped
+  Return
+    number of jobs run
+*/
+uint8_t AbraSched::run() {
+	noInterrupts();
+	uint8_t ticks = pendingTicks;
+	pendingTicks = 0;
+	interrupts();
+	now += ticks;
+
+	uint8_t ran = 0;
+	while (jobCount && ((int32_t)(now - jobs[0].due) >= 0)) {
+		// reschedule before calling so the job can add or clear jobs
+		AbraJob job = jobs[0].job;
+		jobs[0].due += (((now - jobs[0].due) / jobs[0].period) + 1) * jobs[0].period;
+		siftDown(0);
+
+		job();
+		ran++;
+	}
+
+	return ran;
+}
@@ -0,0 +1,90 @@
+#ifndef ABRACONRTCSCHEDULER_H_
+#define ABRACONRTCSCHEDULER_H_
+
+#include <inttypes.h>
+
+// number of jobs that can be registered, storage is allocated statically
+#ifndef ABRA_SCHED_MAX_JOBS
+#define ABRA_SCHED_MAX_JOBS 8
+#endif
+
+// a forward step larger than this is treated as the clock being set, not as elapsed time
+#ifndef ABRA_SCHED_MAX_STEP
+#define ABRA_SCHED_MAX_STEP 3600UL
+#endif
+
+#define SCHED_SECONDS_PER_DAY 86400UL
+
+// job kinds
+#define SCHED_EVERY   0 // every period seconds from when it was registered
+#define SCHED_ALIGNED 1 // every period seconds on the clock (e.g. 3600 runs on the hour)
+#define SCHED_DAILY   2 // once a day at a wall clock time
+
+typedef void (*AbraJob)(void);
+
+struct AbraSchedJob {
+	uint32_t due;	 // scheduler seconds when the job next runs
+	uint32_t period; // seconds between runs
+	uint32_t at;	 // second of the day to run at, for SCHED_DAILY
+	uint8_t	 kind;
+	AbraJob	 job;
+};
+
+/*
+  Cooperative scheduler for periodic and wall clock jobs
+
+  Jobs are kept in a min-heap ordered by when they are next due, so run()
+  only compares the earliest job against the current time however many jobs
+  are registered. Time is counted in whole seconds and is advanced either by
+  tick() from the RTC's 1 Hz CLKOUT interrupt, or by sync() with the second
+  of the day after each RTC.updateRTC().
+
+  Daily and aligned jobs need the time of day, so daily() and every() with
+  aligned set fail until sync() has been called once, also when only tick()
+  drives the scheduler.
+
+  Usage with change detection:
+    AbraSched::sync(RTC.getSecOfDay());
+    AbraSched::every(60, updateDisplay, 1); // on the minute
+    AbraSched::daily(0, 0, 0, resetCounters);
+    ...
+    loop: RTC.updateRTC(); AbraSched::sync(RTC.getSecOfDay()); AbraSched::run();
+
+  Usage with the 1 Hz CLKOUT interrupt:
+    RTC.updateRTC(); AbraSched::sync(RTC.getSecOfDay()); // once, before daily()
+    AbraSched::daily(0, 0, 0, resetCounters);
+    attachInterrupt(digitalPinToInterrupt(2), AbraSched::tick, RISING); // 1 Hz CLKOUT on pin 2
+    ...
+    loop: AbraSched::run();
+*/
+class AbraSched {
+	private:
+		static AbraSchedJob jobs[ABRA_SCHED_MAX_JOBS];
+		static uint8_t  jobCount;
+		static uint32_t now;	   // seconds counted by the scheduler
+		static uint32_t dayOffset; // (now + dayOffset) % SCHED_SECONDS_PER_DAY is the second of the day
+		static bool		synced;
+		static volatile uint8_t pendingTicks;
+
+		static uint32_t firstDue(const AbraSchedJob &entry);
+		static void siftUp(uint8_t i);
+		static void siftDown(uint8_t i);
+		static bool add(AbraSchedJob &entry);
+		static void realign();
+	public:
+		static void clear();
+		static bool every(uint32_t period, AbraJob job, bool aligned=0);
+		static bool daily(uint8_t hour, uint8_t min, uint8_t sec, AbraJob job);
+
+		static void tick();
+		static void sync(uint32_t secOfDay);
+		static void advance(uint32_t secs);
+		static uint8_t run();
+
+		static uint32_t seconds() { return now; }
+		static uint32_t secOfDay() { return (now + dayOffset) % SCHED_SECONDS_PER_DAY; }
+		static uint32_t nextDue() { return jobCount ? jobs[0].due : 0; }
+		static uint8_t count() { return jobCount; }
+};
+
+#endif
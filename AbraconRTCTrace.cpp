@@ -0,0 +1,215 @@
+#include <Arduino.h>
+#include "AbraconRTCTrace.h"
+
+// Initialize Class Variables //////////////////////////////////////////////////
+
+uint8_t  *AbraTrace::traceBuf     = 0;
+uint16_t AbraTrace::traceSize    = 0;
+uint16_t AbraTrace::traceHead    = 0;
+uint16_t AbraTrace::traceTail    = 0;
+uint16_t AbraTrace::traceUsed    = 0;
+uint16_t AbraTrace::traceDropped = 0;
+uint32_t AbraTrace::lastMicros   = 0;
+uint8_t  AbraTrace::callDepth    = 0;
+
+// Constructors ////////////////////////////////////////////////////////////////
+
+/*
+  Description
+    record a call marker if this is the outermost public call, nested calls
+    (such as begin() calling setTime()) are replayed by their caller
+  Input
+    id: TRACE_CALL_* identifier of the call
+    arg0-arg3: call arguments
+*/
+AbraTrace::Call::Call(uint8_t id, uint8_t arg0, uint8_t arg1, uint8_t arg2, uint8_t arg3) {
+	if (callDepth++ == 0) {
+		// the microsecond delta saturates between calls, so calls also carry the time
+		uint32_t now = millis();
+		uint8_t args[TRACE_CALL_ARGS + TRACE_CALL_STAMP] = {arg0, arg1, arg2, arg3,
+			(uint8_t)now, (uint8_t)(now >> 8), (uint8_t)(now >> 16), (uint8_t)(now >> 24)};
+		record(TRACE_CALL_ADDR, TRACE_WRITE, id, args, sizeof(args), 0);
+	}
+}
+
+// Private Methods /////////////////////////////////////////////////////////////
+
+/*
+  Description
+    append a byte at the head of the ring buffer
+  Input
+    val: byte to append
+*/
+void AbraTrace::push(uint8_t val) {
+	traceBuf[traceHead] = val;
+	traceHead = (traceHead + 1 == traceSize) ? 0 : traceHead + 1;
+	traceUsed++;
+}
+
+/*
+  Description
+    get a byte relative to the oldest record
+  Input
+    offset: number of bytes after the tail
+  Return
+    byte at that position
+*/
+uint8_t AbraTrace::peek(uint16_t offset) {
+	uint16_t index = traceTail + offset;
+	if (index >= traceSize) {
+		index -= traceSize;
+	}
+	return traceBuf[index];
+}
+
+/*
+  Description
+    discard the oldest record to make room for a new one
+*/
+void AbraTrace::dropOldest() {
+	uint16_t recordSize = TRACE_HEADER_SIZE + peek(2);
+	traceTail += recordSize;
+	if (traceTail >= traceSize) {
+		traceTail -= traceSize;
+	}
+	traceUsed -= recordSize;
+	traceDropped++;
+}
+
+// Public Methods //////////////////////////////////////////////////////////////
+
+/*
+  Description
+    start recording into a caller owned buffer
+  Input
+    buf: storage for the ring buffer
+    size: size of buf in bytes
+*/
+void AbraTrace::attach(uint8_t *buf, uint16_t size) {
+	traceBuf  = buf;
+	traceSize = size;
+	clear();
+}
+
+/*
+  Description
+    stop recording, the buffer is no longer used
+*/
+void AbraTrace::detach() {
+	traceBuf  = 0;
+	traceSize = 0;
+	clear();
+}
+
+/*
+  Description
+    discard all records
+*/
+void AbraTrace::clear() {
+	traceHead    = 0;
+	traceTail    = 0;
+	traceUsed    = 0;
+	traceDropped = 0;
+	lastMicros   = micros();
+}
+
+/*
+  Description
+    append a transaction record, dropping the oldest records if the buffer is full
+  Input
+    i2cAddr: 7 bit I2C address of the device
+    dir: TRACE_READ or TRACE_WRITE
+    reg: first register address of the transaction
+    data: bytes written or read
+    len: number of bytes in data
+    status: Wire.endTransmission() code or TRACE_SHORT_READ
+*/
+void AbraTrace::record(uint8_t i2cAddr, uint8_t dir, uint8_t reg, const uint8_t *data, uint8_t len, uint8_t status) {
+	uint16_t recordSize = TRACE_HEADER_SIZE + len;
+	if (recordSize > traceSize) { // not attached or record can never fit
+		traceDropped++;
+		return;
+	}
+
+	while ((traceSize - traceUsed) < recordSize) {
+		dropOldest();
+	}
+
+	uint32_t now = micros();
+	uint32_t elapsed = now - lastMicros;
+	lastMicros = now;
+	if (elapsed > 0xFFFF) {
+		elapsed = 0xFFFF;
+	}
+
+	push((i2cAddr << 1) | dir);
+	push(reg);
+	push(len);
+	push(status);
+	push(elapsed & 0xFF);
+	push(elapsed >> 8);
+	for (uint8_t i = 0; i < len; i++) {
+		push(data[i]);
+	}
+}
+
+/*
+  Description
+    move whole records out of the ring buffer, oldest first
+  Input
+    out: destination for record bytes
+    maxLen: size of out in bytes
+  Return
+    number of bytes copied
+*/
+uint16_t AbraTrace::read(uint8_t *out, uint16_t maxLen) {
+	uint16_t copied = 0;
+	while (traceUsed) {
+		uint16_t recordSize = TRACE_HEADER_SIZE + peek(2);
+		if ((maxLen - copied) < recordSize) {
+			break;
+		}
+		for (uint16_t i = 0; i < recordSize; i++) {
+			out[copied++] = peek(i);
+		}
+		traceTail += recordSize;
+		if (traceTail >= traceSize) {
+			traceTail -= traceSize;
+		}
+		traceUsed -= recordSize;
+	}
+	return copied;
+}
+
+/*
+  Description
+    print and remove all records as hex, one record per line, in the format
+    read by extras/trace_replay
+  Input
+    out: where to print (e.g. Serial)
+*/
+void AbraTrace::dump(Print &out) {
+	static const char hexDigits[] = "0123456789ABCDEF";
+
+	if (traceDropped) {
+		out.print(F("# dropped "));
+		out.println(traceDropped);
+	}
+
+	while (traceUsed) {
+		uint16_t recordSize = TRACE_HEADER_SIZE + peek(2);
+		for (uint16_t i = 0; i < recordSize; i++) {
+			uint8_t val = peek(i);
+			out.write(hexDigits[val >> 4]);
+			out.write(hexDigits[val & 0x0F]);
+		}
+		out.println();
+
+		traceTail += recordSize;
+		if (traceTail >= traceSize) {
+			traceTail -= traceSize;
+		}
+		traceUsed -= recordSize;
+	}
+	traceDropped = 0;
+}
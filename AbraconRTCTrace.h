@@ -0,0 +1,107 @@
+#ifndef ABRACONRTCTRACE_H_
+#define ABRACONRTCTRACE_H_
+
+#include <inttypes.h>
+
+// set to 1 (here or with -DABRA_RTC_TRACE=1) to record every I2C transaction
+#ifndef ABRA_RTC_TRACE
+#define ABRA_RTC_TRACE 0
+#endif
+
+// transaction direction
+#define TRACE_WRITE 	 0
+#define TRACE_READ  	 1
+
+// status codes are Wire.endTransmission() codes (0 success, 1-4 error) plus
+#define TRACE_SHORT_READ 5 // fewer bytes returned than requested
+
+// records with this I2C address mark the start of a public AbraRTC call
+#define TRACE_CALL_ADDR  0x00
+
+// public AbraRTC calls, stored in the register byte of call records
+#define TRACE_CALL_BEGIN			 1
+#define TRACE_CALL_UPDATE			 2
+#define TRACE_CALL_SET_TIME			 3
+#define TRACE_CALL_SET_TRICKLE_CHARGE 4
+#define TRACE_CALL_SET_HR_FORMAT	 5
+#define TRACE_CALL_TOGGLE_HR_FORMAT	 6
+#define TRACE_CALL_INC_HOUR			 7
+#define TRACE_CALL_DEC_HOUR			 8
+#define TRACE_CALL_INC_MIN			 9
+#define TRACE_CALL_DEC_MIN			 10
+#define TRACE_CALL_BEGIN_CONFIG		 11
+#define TRACE_CALL_STAGE_TIME		 12
+#define TRACE_CALL_STAGE_HR_FORMAT	 13
+#define TRACE_CALL_STAGE_BITS		 14
+#define TRACE_CALL_COMMIT_CONFIG	 15
+#define TRACE_CALL_SET_CLKOUT		 16
+#define TRACE_CALL_ENABLE_CLKOUT	 17
+#define TRACE_CALL_SET_RECOVERY_POLICY 18
+#define TRACE_CALL_LOG_ALIVE		 19
+#define TRACE_CALL_GET_POWER_EVENT	 20
+#define TRACE_CALL_READ_FIELD		 21 // readField() and readBits()
+#define TRACE_CALL_WRITE_FIELD		 22 // writeField() and writeBits()
+
+#define TRACE_HEADER_SIZE 6
+#define TRACE_CALL_ARGS   4
+#define TRACE_CALL_STAMP  4 // millis() timestamp after the call arguments
+
+/*
+  Trace record layout, TRACE_HEADER_SIZE bytes followed by the data bytes
+    0: I2C address << 1 | direction (TRACE_READ or TRACE_WRITE)
+    1: register address (or TRACE_CALL_* for call records)
+    2: number of data bytes
+    3: status
+    4: microseconds since previous record, low byte
+    5: microseconds since previous record, high byte (saturates at 0xFFFF)
+    6: data bytes written or read, or for call records TRACE_CALL_ARGS call
+       arguments followed by the 32 bit millis() time of the call, low byte first
+*/
+
+class Print;
+
+class AbraTrace {
+	private:
+		static uint8_t  *traceBuf;
+		static uint16_t traceSize;
+		static uint16_t traceHead; // index where next byte is written
+		static uint16_t traceTail; // index of oldest record
+		static uint16_t traceUsed;
+		static uint16_t traceDropped;
+		static uint32_t lastMicros;
+		static uint8_t  callDepth;
+
+		static void push(uint8_t val);
+		static uint8_t peek(uint16_t offset);
+		static void dropOldest();
+	public:
+		/*
+		  Description
+		    records the outermost public AbraRTC call for the lifetime of the object
+		*/
+		class Call {
+			public:
+				Call(uint8_t id, uint8_t arg0=0, uint8_t arg1=0, uint8_t arg2=0, uint8_t arg3=0);
+				~Call() { callDepth--; }
+		};
+
+		static void attach(uint8_t *buf, uint16_t size);
+		static void detach();
+		static void clear();
+		static void record(uint8_t i2cAddr, uint8_t dir, uint8_t reg, const uint8_t *data, uint8_t len, uint8_t status);
+
+		static uint16_t available() { return traceUsed; }
+		static uint16_t dropped() { return traceDropped; }
+		static uint16_t read(uint8_t *out, uint16_t maxLen);
+		static void dump(Print &out);
+};
+
+#if ABRA_RTC_TRACE
+#define ABRA_TRACE_BUS(dir, reg, data, len, status) AbraTrace::record(RTC_ADDR, dir, reg, data, len, status)
+#define ABRA_TRACE_CALL(...) AbraTrace::Call traceCall(__VA_ARGS__)
+#else
+#define ABRA_TRACE_BUS(dir, reg, data, len, status)
+#define ABRA_TRACE_CALL(...)
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/*
+  Runs AbraClock against a simulated CLKOUT signal and host timer on a host PC
+
+  Build from the library root:
+    g++ -std=gnu++11 -fpermissive -O2 -I extras/host -I . -o clock_sim \
+        extras/clock_sim/clock_sim.cpp AbraconRTCClock.cpp \
+        extras/host/HostCheck.cpp
+
+  Usage:
+    clock_sim [-l]
+
+  Exit status 1 if any check failed, see extras/host/HostCheck.h.
+  -l adds 50 days at 1024 Hz, past 2^32 CLKOUT edges (takes a minute or two).
+*/
+
+#include <string.h>
+#include "AbraconRTCClock.h"
+#include "HostCheck.h"
+
+static uint64_t hostMicros = 0; // true host time, micros() wraps it to 32 bits
+static void (*edgeIsr)(void) = 0;
+
+uint32_t micros() { return (uint32_t)hostMicros; }
+uint32_t millis() { return (uint32_t)(hostMicros / 1000); }
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode) { (void)interrupt; (void)mode; edgeIsr = isr; }
+void detachInterrupt(uint8_t interrupt) { (void)interrupt; edgeIsr = 0; }
+
+/*
+  Description
+    feed CLKOUT edges to AbraClock for a number of RTC seconds, sampling
+    millis() between edges
+  Input
+    clkOutFreq: CLKOUT_* frequency
+    hz: edges per second for clkOutFreq
+    seconds: RTC seconds to run
+    hostPpm: host timer error, positive if it runs fast
+    samples: millis() reads per edge period
+  Return
+    true if millis() never went backwards (modulo 2^32) or ahead of the RTC
+*/
+static bool run(uint8_t clkOutFreq, uint32_t hz, uint32_t seconds, int32_t hostPpm, uint8_t samples) {
+	hostMicros = 0;
+	AbraClock::begin(2, clkOutFreq);
+
+	double period = (1000000.0 / hz) * (1.0 + hostPpm / 1000000.0); // host micros per edge
+	double hostStart = 0;
+	uint32_t last = AbraClock::millis();
+	bool ok = 1;
+
+	for (uint64_t edge = 1; edge <= (uint64_t)seconds * hz; edge++) {
+		for (uint8_t i = 1; i <= samples; i++) {
+			hostMicros = (uint64_t)(hostStart + period * (edge - 1) + period * i / (samples + 1));
+			uint32_t now = AbraClock::millis();
+			uint32_t rtcMillis = (uint32_t)(edge * 1000 / hz); // RTC time at the next edge
+			if ((int32_t)(now - last) < 0 || (int32_t)(now - rtcMillis) > 0) {
+				ok = 0;
+			}
+			last = now;
+		}
+		hostMicros = (uint64_t)(hostStart + period * edge);
+		edgeIsr();
+	}
+	return ok;
+}
+
+int main(int argc, char **argv) {
+	bool ok = run(CLKOUT_32HZ, 32, 3600, 192, 4);
+	HostCheck::check(ok, "32 Hz, host 192 ppm fast: millis() monotonic and never ahead of the RTC");
+	HostCheck::check(AbraClock::millis() == 3600000UL, "32 Hz, host 192 ppm fast: 1 hour reads 3600000 ms");
+	HostCheck::check(AbraClock::seconds() == 3600, "32 Hz, host 192 ppm fast: 1 hour reads 3600 s");
+	HostCheck::check(AbraClock::driftPpm() == 192, "32 Hz, host 192 ppm fast: drift settles on 192 ppm");
+
+	run(CLKOUT_1024HZ, 1024, 600, -75, 1);
+	HostCheck::check(AbraClock::millis() == 600000UL, "1024 Hz, host 75 ppm slow: 10 minutes read 600000 ms");
+	HostCheck::check(AbraClock::driftPpm() == -75, "1024 Hz, host 75 ppm slow: drift settles on -75 ppm");
+
+	// past 2^32 ms (49.7 days), millis() must wrap the same way ::millis() does
+	ok = run(CLKOUT_1HZ, 1, 50UL * 86400, 0, 2);
+	HostCheck::check(ok, "1 Hz, 50 days: millis() monotonic across the 2^32 ms wrap");
+	HostCheck::check(AbraClock::millis() == (uint32_t)(50ULL * 86400 * 1000), "1 Hz, 50 days: millis() wraps at 2^32");
+	HostCheck::check(AbraClock::seconds() == 50UL * 86400, "1 Hz, 50 days: seconds() keeps counting");
+
+	if ((argc > 1) && !strcmp(argv[1], "-l")) {
+		ok = run(CLKOUT_1024HZ, 1024, 50UL * 86400, 0, 1);
+		HostCheck::check(ok, "1024 Hz, 50 days: millis() monotonic past 2^32 edges");
+		HostCheck::check(AbraClock::millis() == (uint32_t)(50ULL * 86400 * 1000), "1024 Hz, 50 days: millis() wraps at 2^32");
+	}
+
+	return HostCheck::status();
+}
@@ -0,0 +1,22 @@
+#include <stdio.h>
+#include "Arduino.h"
+
+// Print ///////////////////////////////////////////////////////////////////////
+
+size_t Print::print(const char *str) {
+	size_t len = 0;
+	while (*str) {
+		len += write(*str++);
+	}
+	return len;
+}
+
+size_t Print::println(unsigned int val) {
+	char str[12];
+	snprintf(str, sizeof(str), "%u", val);
+	return print(str) + println();
+}
+
+size_t Print::println() {
+	return print("\r\n");
+}
@@ -0,0 +1,35 @@
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+// Minimal Arduino core declarations for building the library on a host PC.
+// Print is defined in Arduino.cpp, the host program provides the rest.
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#define F(str) (str)
+
+#define INPUT  0
+#define RISING 3
+
+#define noInterrupts()
+#define interrupts()
+#define digitalPinToInterrupt(pin) ((pin) == 2 ? 0 : ((pin) == 3 ? 1 : -1))
+
+uint32_t millis();
+uint32_t micros();
+void pinMode(uint8_t pin, uint8_t mode);
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+class Print {
+	public:
+		virtual ~Print() {}
+		virtual size_t write(uint8_t val) = 0;
+		size_t write(char val) { return write((uint8_t)val); }
+		size_t print(const char *str);
+		size_t println(unsigned int val);
+		size_t println();
+};
+
+#endif
@@ -0,0 +1,21 @@
+#include <stdio.h>
+#include "HostCheck.h"
+
+int HostCheck::failures = 0;
+
+/*
+  Description
+    print the result of a check and count it if it failed
+  Input
+    ok: true if the check passed
+    what: what was checked
+  Return
+    ok
+*/
+bool HostCheck::check(bool ok, const char *what) {
+	printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+	if (!ok) {
+		failures++;
+	}
+	return ok;
+}
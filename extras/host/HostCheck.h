@@ -0,0 +1,16 @@
+#ifndef HOSTCHECK_H_
+#define HOSTCHECK_H_
+
+// Pass/fail reporting shared by the host tools in extras/. Each check prints
+// a line starting with ok or FAIL, and status() is the exit status: 1 if any
+// check failed.
+
+class HostCheck {
+	private:
+		static int failures;
+	public:
+		static bool check(bool ok, const char *what);
+		static int status() { return failures ? 1 : 0; }
+};
+
+#endif
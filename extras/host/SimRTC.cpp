@@ -0,0 +1,166 @@
+#include <Wire.h>
+#include "AbraconRTCRegs.h"
+#include "SimRTC.h"
+
+static uint8_t txBuf[32];
+static uint8_t txLen = 0;
+static uint8_t selectedReg = 0;
+static uint8_t rxBuf[32];
+static uint8_t rxLen = 0;
+static uint8_t rxPos = 0;
+
+static SimDevice regsDevice;
+
+// Initialize Class Variables //////////////////////////////////////////////////
+
+uint8_t   SimRTC::regs[256]    = {0};
+SimDevice *SimRTC::device      = &regsDevice;
+uint32_t  SimRTC::transactions = 0;
+uint32_t  SimRTC::bytes        = 0;
+uint8_t   SimRTC::failStatus   = 0;
+bool	  SimRTC::failShort    = 0;
+
+TwoWire Wire;
+
+// Register Page ///////////////////////////////////////////////////////////////
+
+/*
+  Description
+    select a register ahead of a read
+  Input
+    reg: register selected
+  Return
+    Wire.endTransmission() status, 0 for success
+*/
+uint8_t SimDevice::select(uint8_t reg) {
+	(void)reg;
+	return 0;
+}
+
+/*
+  Description
+    write consecutive registers, flags in the interrupt flag and status
+    registers are cleared by writing 0 and left as they are by writing 1
+  Input
+    reg: first register written
+    vals: values written
+    len: number of registers written
+  Return
+    Wire.endTransmission() status, 0 for success
+*/
+uint8_t SimDevice::write(uint8_t reg, const uint8_t *vals, uint8_t len) {
+	for (uint8_t i = 0; i < len; i++) {
+		uint8_t addr = reg + i;
+		if ((addr == CTL_INT_FLAG_ADDR) || (addr == CTL_STAT_ADDR)) {
+			SimRTC::regs[addr] &= vals[i];
+		} else {
+			SimRTC::regs[addr] = vals[i];
+		}
+	}
+	return 0;
+}
+
+/*
+  Description
+    read consecutive registers, the simulated EEPROM is never busy
+  Input
+    reg: first register read, as selected
+    vals: values read
+    len: number of registers requested
+  Return
+    number of registers read
+*/
+uint8_t SimDevice::read(uint8_t reg, uint8_t *vals, uint8_t len) {
+	for (uint8_t i = 0; i < len; i++) {
+		uint8_t addr = reg + i;
+		vals[i] = SimRTC::regs[addr];
+		if (addr == CTL_STAT_ADDR) {
+			vals[i] = AbraReg::STAT_EEBUSY::set(vals[i], 0);
+		}
+	}
+	return len;
+}
+
+/*
+  Description
+    set the clock page as the RTC keeps it, 24-hour BCD
+  Input
+    hour: 0-23
+    min: 0-59
+    sec: 0-59
+    date: 1-31
+*/
+void SimRTC::setClock(uint8_t hour, uint8_t min, uint8_t sec, uint8_t date) {
+	regs[SEC_ADDR]  = ((sec / 10) << 4) | (sec % 10);
+	regs[MIN_ADDR]  = ((min / 10) << 4) | (min % 10);
+	regs[HOUR_ADDR] = ((hour / 10) << 4) | (hour % 10);
+	regs[DATE_ADDR] = ((date / 10) << 4) | (date % 10);
+}
+
+// Wire ////////////////////////////////////////////////////////////////////////
+
+void TwoWire::begin() {}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+	(void)addr;
+	txLen = 0;
+}
+
+size_t TwoWire::write(uint8_t val) {
+	if (txLen >= sizeof(txBuf)) { return 0; }
+	txBuf[txLen++] = val;
+	return 1;
+}
+
+size_t TwoWire::write(const uint8_t *vals, size_t len) {
+	for (size_t i = 0; i < len; i++) {
+		if (!write(vals[i])) { return i; }
+	}
+	return len;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+	(void)sendStop;
+	if (txLen == 0) { return 0; }
+
+	uint8_t status = SimRTC::failStatus;
+	SimRTC::failStatus = 0;
+	if ((status == 0) && (txLen == 1)) { // register select ahead of a read, counted in requestFrom()
+		selectedReg = txBuf[0];
+		status = SimRTC::device->select(selectedReg);
+		if (status == 0) { return 0; }
+	} else if (status == 0) {
+		status = SimRTC::device->write(txBuf[0], &txBuf[1], txLen - 1);
+	}
+
+	SimRTC::transactions++;
+	SimRTC::bytes += 1 + txLen;
+	return status;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t len) {
+	(void)addr;
+	SimRTC::transactions++;
+	SimRTC::bytes += 3 + len;
+	rxPos = 0;
+	rxLen = 0;
+	if (len > sizeof(rxBuf)) {
+		len = sizeof(rxBuf);
+	}
+
+	if (SimRTC::failShort) {
+		SimRTC::failShort = 0;
+	} else {
+		rxLen = SimRTC::device->read(selectedReg, rxBuf, len);
+	}
+	return rxLen;
+}
+
+int TwoWire::available() {
+	return rxLen - rxPos;
+}
+
+int TwoWire::read() {
+	if (rxPos >= rxLen) { return -1; }
+	return rxBuf[rxPos++];
+}
@@ -0,0 +1,32 @@
+#ifndef SIMRTC_H_
+#define SIMRTC_H_
+
+// Simulated RTC behind the host Wire, shared by the host tools in extras/.
+// SimRTC.cpp defines TwoWire and Wire, so a tool built with it doesn't define
+// its own bus.
+
+#include "Arduino.h"
+
+// answers bus transactions, by default from SimRTC::regs, a tool can answer
+// from elsewhere (trace_replay answers from a capture) with a derived class
+class SimDevice {
+	public:
+		virtual ~SimDevice() {}
+		virtual uint8_t select(uint8_t reg);
+		virtual uint8_t write(uint8_t reg, const uint8_t *vals, uint8_t len);
+		virtual uint8_t read(uint8_t reg, uint8_t *vals, uint8_t len);
+};
+
+class SimRTC {
+	public:
+		static uint8_t	 regs[256];		// register page, addresses wrap at 0xFF
+		static SimDevice *device;		// answers transactions, regs unless replaced
+		static uint32_t	 transactions;	// a register select and the read after it count as one
+		static uint32_t	 bytes;			// bytes on the wire, I2C address bytes included
+		static uint8_t	 failStatus;	// if set, the next transaction fails with this status
+		static bool		 failShort;		// if set, the next read returns no bytes
+
+		static void setClock(uint8_t hour, uint8_t min, uint8_t sec, uint8_t date);
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef WIRE_H_
+#define WIRE_H_
+
+// Minimal Wire (I2C) declarations for building the library on a host PC.
+// The host program provides the definitions, typically a simulated RTC.
+
+#include "Arduino.h"
+
+class TwoWire {
+	public:
+		void begin();
+		void beginTransmission(uint8_t addr);
+		size_t write(uint8_t val);
+		size_t write(const uint8_t *vals, size_t len);
+		uint8_t endTransmission(bool sendStop=true);
+		uint8_t requestFrom(uint8_t addr, uint8_t len);
+		int available();
+		int read();
+};
+
+extern TwoWire Wire;
+
+#endif
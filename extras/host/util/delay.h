@@ -0,0 +1,7 @@
+#ifndef UTIL_DELAY_H_
+#define UTIL_DELAY_H_
+
+// host builds don't need to wait on real hardware
+static inline void _delay_ms(double ms) { (void)ms; }
+
+#endif
@@ -0,0 +1,147 @@
+/*
+  Runs AbraRTC power event handling against a simulated RTC on a host PC
+
+  Build from the library root:
+    g++ -std=gnu++11 -fpermissive -I extras/host -I . -o power_sim \
+        extras/power_sim/power_sim.cpp AbraconRTC.cpp \
+        extras/host/SimRTC.cpp extras/host/HostCheck.cpp
+
+  Usage:
+    power_sim
+
+  Exit status 1 if any check failed, see extras/host/HostCheck.h. Bus
+  transactions are counted by extras/host/SimRTC.
+*/
+
+#include <string.h>
+#include "AbraconRTC.h"
+#include "HostCheck.h"
+#include "SimRTC.h"
+
+AbraRTC RTC;
+
+uint32_t millis() { return 0; }
+uint32_t micros() { return 0; }
+
+// sets the alarm and V_LOW2 flags on the first clock page read, after begin() read the flags
+class LateFlagDevice : public SimDevice {
+	public:
+		bool armed;
+		uint8_t read(uint8_t reg, uint8_t *vals, uint8_t len) {
+			if (armed && (reg == SEC_ADDR)) {
+				SimRTC::regs[CTL_INT_FLAG_ADDR] |= AbraReg::INTF_AF::mask;
+				SimRTC::regs[CTL_STAT_ADDR]     |= AbraReg::STAT_V2F::mask;
+				armed = 0;
+			}
+			return SimDevice::read(reg, vals, len);
+		}
+};
+
+// fails writes to the interrupt flag and status registers, as if power was lost before them
+class FlagWriteFailDevice : public SimDevice {
+	public:
+		uint8_t write(uint8_t reg, const uint8_t *vals, uint8_t len) {
+			if ((reg <= CTL_STAT_ADDR) && (reg + len > CTL_INT_FLAG_ADDR)) {
+				return 2;
+			}
+			return SimDevice::write(reg, vals, len);
+		}
+};
+
+// Checks //////////////////////////////////////////////////////////////////////
+
+static uint32_t timedBegin() {
+	SimRTC::transactions = 0;
+	RTC.begin();
+	return SimRTC::transactions;
+}
+
+int main() {
+	RTCPowerEvent event;
+
+	// first power up: time and RAM lost, trickle charger off
+	memset(&SimRTC::regs[RAM_ADDR], 0xFF, RAM_SIZE);
+	SimRTC::regs[CTL_1_ADDR]    = AbraReg::CTL1_EERE::mask;
+	SimRTC::regs[CTL_STAT_ADDR] = AbraReg::STAT_PON::mask;
+	SimRTC::regs[TEMP_ADDR]     = 85;
+	SimRTC::setClock(0, 0, 42, 1);
+	HostCheck::check(timedBegin() == 14, "power-on reset: begin() takes 14 transactions, 4 of them enabling the trickle charger");
+	HostCheck::check(RTC.getPowerFlags() == POWER_PON, "power-on reset: POWER_PON reported");
+	HostCheck::check(SimRTC::regs[CTL_STAT_ADDR] == 0, "power-on reset: status flags cleared");
+	HostCheck::check(SimRTC::regs[SEC_ADDR] == 0 && SimRTC::regs[MIN_ADDR] == 0 && SimRTC::regs[HOUR_ADDR] == 0, "power-on reset: time reset to midnight");
+	HostCheck::check(AbraReg::EECTL_R1K::get(SimRTC::regs[EE_CTL_ADDR]), "power-on reset: trickle charger enabled");
+	RTC.getPowerEvent(event);
+	HostCheck::check(event.flags == POWER_PON && event.secOfDay == 42, "power-on reset: event logged with the time found");
+	HostCheck::check(!event.aliveValid && event.downSeconds == -1, "power-on reset: RAM lost, downtime unknown");
+
+	// power-on reset again, trickle charger already enabled in EEPROM
+	SimRTC::regs[CTL_STAT_ADDR] = AbraReg::STAT_PON::mask;
+	HostCheck::check(timedBegin() == 9, "power-on reset, charger enabled: begin() takes 9 transactions");
+
+	// host down for 5 min 30 s while the RTC ran on backup
+	SimRTC::setClock(10, 0, 0, 15);
+	RTC.logAlive();
+	SimRTC::setClock(10, 5, 30, 15);
+	SimRTC::regs[CTL_STAT_ADDR] = AbraReg::STAT_V1F::mask;
+	HostCheck::check(timedBegin() == 7, "low voltage 1: begin() takes 7 transactions");
+	RTC.getPowerEvent(event);
+	HostCheck::check(event.flags == POWER_LOW_V1 && event.aliveValid, "low voltage 1: event logged after logAlive()");
+	HostCheck::check(event.downSeconds == 330, "low voltage 1: 330 s downtime");
+	HostCheck::check(SimRTC::regs[HOUR_ADDR] == 0x10 && SimRTC::regs[MIN_ADDR] == 0x05, "low voltage 1: time kept");
+	SimRTC::setClock(10, 6, 0, 15);
+	RTC.logAlive();
+	RTC.getPowerEvent(event);
+	HostCheck::check(event.downSeconds == 330, "low voltage 1: still 330 s downtime after the next logAlive()");
+
+	// host down for 25 hours, the same time of day on the next date
+	SimRTC::setClock(10, 0, 0, 15);
+	RTC.logAlive();
+	SimRTC::setClock(11, 0, 0, 16);
+	SimRTC::regs[CTL_STAT_ADDR] = AbraReg::STAT_V1F::mask;
+	timedBegin();
+	RTC.getPowerEvent(event);
+	HostCheck::check(event.flags == POWER_LOW_V1 && event.downSeconds == -1, "25 hour outage: downtime unknown, not 1 hour");
+
+	HostCheck::check(timedBegin() == 3, "clean boot: begin() takes 3 transactions");
+
+	// power lost again before begin() cleared the flags: the event is already logged
+	FlagWriteFailDevice flagWriteFail;
+	SimDevice *regsDevice = SimRTC::device;
+	SimRTC::device = &flagWriteFail;
+	memset(&SimRTC::regs[RAM_ADDR], 0, RAM_SIZE);
+	SimRTC::regs[CTL_STAT_ADDR] = AbraReg::STAT_V2F::mask;
+	SimRTC::setClock(10, 7, 0, 15);
+	HostCheck::check(!RTC.begin() && (SimRTC::regs[POWER_EVENT_ADDR + 3] & POWER_LOG_BIT),
+		"power lost before the flags are cleared: event already in RAM");
+	SimRTC::device = regsDevice;
+	timedBegin();
+
+	// flags set while begin() handles a power event are left for the next begin()
+	LateFlagDevice lateFlags;
+	lateFlags.armed = 1;
+	SimRTC::device = &lateFlags;
+	SimRTC::regs[CTL_STAT_ADDR] = AbraReg::STAT_V1F::mask;
+	timedBegin();
+	SimRTC::device = regsDevice;
+	HostCheck::check(!AbraReg::STAT_V1F::get(SimRTC::regs[CTL_STAT_ADDR]), "flag set during begin(): the flag found is cleared");
+	HostCheck::check(AbraReg::STAT_V2F::get(SimRTC::regs[CTL_STAT_ADDR]) && AbraReg::INTF_AF::get(SimRTC::regs[CTL_INT_FLAG_ADDR]),
+		"flag set during begin(): alarm and low voltage 2 flags set since are kept");
+
+	// clearing one flag with writeField() leaves the others set
+	SimRTC::regs[CTL_INT_FLAG_ADDR] |= AbraReg::INTF_TF::mask;
+	SimRTC::transactions = 0;
+	RTC.writeField<AbraReg::INTF_AF>(0);
+	HostCheck::check((SimRTC::transactions == 1) && !AbraReg::INTF_AF::get(SimRTC::regs[CTL_INT_FLAG_ADDR]) &&
+		AbraReg::INTF_TF::get(SimRTC::regs[CTL_INT_FLAG_ADDR]), "writeField() clears the alarm flag alone, without reading it");
+	SimRTC::regs[CTL_INT_FLAG_ADDR] = 0;
+	SimRTC::regs[CTL_STAT_ADDR] = 0;
+
+	// power-on reset with recovery turned off
+	RTC.setRecoveryPolicy(0);
+	SimRTC::setClock(10, 5, 0, 15);
+	SimRTC::regs[CTL_STAT_ADDR] = AbraReg::STAT_PON::mask;
+	HostCheck::check(timedBegin() == 6, "power-on reset, policy 0: begin() takes 6 transactions");
+	HostCheck::check(SimRTC::regs[HOUR_ADDR] == 0x10 && SimRTC::regs[MIN_ADDR] == 0x05, "power-on reset, policy 0: time not reset");
+
+	return HostCheck::status();
+}
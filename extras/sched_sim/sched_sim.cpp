@@ -0,0 +1,119 @@
+/*
+  Runs AbraSched against a simulated RTC clock on a host PC
+
+  Build from the library root:
+    g++ -std=gnu++11 -fpermissive -I extras/host -I . -o sched_sim \
+        extras/sched_sim/sched_sim.cpp AbraconRTCScheduler.cpp \
+        extras/host/HostCheck.cpp
+
+  Usage:
+    sched_sim
+
+  Exit status 1 if any check failed, see extras/host/HostCheck.h.
+*/
+
+#include "AbraconRTCScheduler.h"
+#include "HostCheck.h"
+
+static uint32_t tenSecRuns = 0;
+static uint32_t minuteRuns = 0;
+static uint32_t midnightRuns = 0;
+static uint32_t lunchRuns = 0;
+static uint32_t lastMidnightSecOfDay = 0;
+static uint32_t lastMinuteSecOfDay = 0;
+static bool minuteAligned = 1;
+
+static void tenSecJob() { tenSecRuns++; }
+static void minuteJob() {
+	minuteRuns++;
+	lastMinuteSecOfDay = AbraSched::secOfDay();
+	if (lastMinuteSecOfDay % 60) {
+		minuteAligned = 0;
+	}
+}
+static void midnightJob() { midnightRuns++; lastMidnightSecOfDay = AbraSched::secOfDay(); }
+static void lunchJob() { lunchRuns++; }
+
+static void reset() {
+	AbraSched::clear();
+	tenSecRuns = minuteRuns = midnightRuns = lunchRuns = 0;
+	minuteAligned = 1;
+}
+
+static void addJobs() {
+	AbraSched::every(10, tenSecJob);
+	AbraSched::every(60, minuteJob, 1);
+	AbraSched::daily(0, 0, 0, midnightJob);
+	AbraSched::daily(12, 30, 0, lunchJob);
+}
+
+int main() {
+	// the time of day isn't known before the first sync()
+	HostCheck::check(!AbraSched::daily(0, 0, 0, midnightJob) && !AbraSched::every(60, minuteJob, 1),
+		"not synced: daily and aligned jobs refused");
+	HostCheck::check(AbraSched::every(10, tenSecJob) && (AbraSched::count() == 1), "not synced: every 10 s accepted");
+
+	// two days from 23:59:30, the RTC read every third second, 1 Hz ticks in between
+	reset();
+	uint32_t sod = (23 * 3600UL) + (59 * 60UL) + 30;
+	AbraSched::sync(sod);
+	addJobs();
+	for (uint32_t i = 0; i < 2 * SCHED_SECONDS_PER_DAY; i++) {
+		sod = (sod + 1) % SCHED_SECONDS_PER_DAY;
+		if (i % 3 == 0) {
+			AbraSched::sync(sod);
+		} else {
+			AbraSched::tick();
+		}
+		AbraSched::run();
+	}
+	HostCheck::check(tenSecRuns == 2 * SCHED_SECONDS_PER_DAY / 10, "sync and tick, 2 days: every 10 s ran 17280 times");
+	HostCheck::check(minuteRuns == 2 * 24 * 60, "sync and tick, 2 days: aligned 60 s ran 2880 times");
+	HostCheck::check(minuteAligned, "sync and tick, 2 days: aligned 60 s always ran on the minute");
+	HostCheck::check(midnightRuns == 2 && lastMidnightSecOfDay == 0, "sync and tick, 2 days: daily 00:00:00 ran twice at midnight");
+	HostCheck::check(lunchRuns == 2, "sync and tick, 2 days: daily 12:30:00 ran twice");
+
+	// clock set back 2 hours: nothing is due again until the clock catches up
+	uint32_t minuteBefore = minuteRuns;
+	uint32_t midnightBefore = midnightRuns;
+	sod = (sod + SCHED_SECONDS_PER_DAY - 2 * 3600UL) % SCHED_SECONDS_PER_DAY;
+	AbraSched::sync(sod);
+	HostCheck::check(AbraSched::run() == 0, "clock set back 2 hours: no job ran");
+	HostCheck::check(minuteRuns == minuteBefore && midnightRuns == midnightBefore, "clock set back 2 hours: wall clock jobs not repeated");
+	sod = (sod + 60) % SCHED_SECONDS_PER_DAY;
+	AbraSched::sync(sod);
+	AbraSched::run();
+	HostCheck::check(minuteRuns == minuteBefore + 1 && lastMinuteSecOfDay == sod, "clock set back 2 hours: aligned 60 s realigned to the new time");
+
+	// clock set forward 2 hours past 12:30: the skipped daily job doesn't run
+	reset();
+	AbraSched::sync(12 * 3600UL);
+	addJobs();
+	AbraSched::sync(14 * 3600UL);
+	AbraSched::run();
+	HostCheck::check(lunchRuns == 0, "clock set forward past 12:30: daily job not run");
+	HostCheck::check(AbraSched::nextDue() - AbraSched::seconds() == 10, "clock set forward past 12:30: every 10 s still next");
+
+	// 1 Hz ticks only, one day from 00:00:30
+	reset();
+	AbraSched::sync(30);
+	addJobs();
+	for (uint32_t i = 0; i < SCHED_SECONDS_PER_DAY; i++) {
+		AbraSched::tick();
+		AbraSched::run();
+	}
+	HostCheck::check(tenSecRuns == SCHED_SECONDS_PER_DAY / 10, "tick only, 1 day: every 10 s ran 8640 times");
+	HostCheck::check(minuteRuns == 24 * 60 && minuteAligned, "tick only, 1 day: aligned 60 s ran 1440 times on the minute");
+	HostCheck::check(midnightRuns == 1 && lunchRuns == 1, "tick only, 1 day: each daily job ran once");
+
+	// scheduler not run for an hour: missed runs are skipped, each job runs once
+	reset();
+	AbraSched::sync(0);
+	addJobs();
+	AbraSched::run();
+	AbraSched::advance(3600);
+	HostCheck::check(AbraSched::run() == 2, "not run for an hour: every 10 s and aligned 60 s ran once each");
+	HostCheck::check(AbraSched::run() == 0, "not run for an hour: nothing left due");
+
+	return HostCheck::status();
+}
@@ -0,0 +1,106 @@
+/*
+  Calls every AbraRTC method available in the selected ABRA_RTC_PROFILE so
+  that size_bench.sh can measure what each profile costs once linked with
+  --gc-sections. The bus is stubbed out, the program is only built, not run.
+
+  Build one profile from the library root:
+    g++ -std=gnu++11 -fpermissive -Os -ffunction-sections -fdata-sections \
+        -Wl,--gc-sections -DABRA_RTC_PROFILE=2 -I extras/host -I . \
+        -o size_bench extras/size_bench/size_bench.cpp AbraconRTC.cpp
+
+  Built with -DSIZE_BENCH_EMPTY and without AbraconRTC.cpp, it only keeps the
+  stubs, giving the image size that every profile is measured against. Built
+  with -DSIZE_BENCH_BEGIN, it only calls begin(), updateRTC() and the getters,
+  as a sketch that just shows the time does.
+*/
+
+#include <Wire.h>
+#include "AbraconRTC.h"
+
+// Bus Stubs ///////////////////////////////////////////////////////////////////
+
+// volatile so the compiler can't fold the driver's error paths away
+static volatile uint8_t busVal = 0;
+
+// not inlined, so the empty build keeps the same stubs as the library builds
+#define STUB __attribute__((noinline))
+
+TwoWire Wire;
+
+STUB void TwoWire::begin() { busVal = 0; }
+STUB void TwoWire::beginTransmission(uint8_t addr) { busVal = addr; }
+STUB size_t TwoWire::write(uint8_t val) { busVal = val; return 1; }
+STUB size_t TwoWire::write(const uint8_t *vals, size_t len) { busVal = vals[0]; return len; }
+STUB uint8_t TwoWire::endTransmission(bool sendStop) { return busVal; }
+STUB uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t len) { return busVal ? len : 0; }
+STUB int TwoWire::available() { return busVal; }
+STUB int TwoWire::read() { return busVal; }
+
+STUB uint32_t millis() { return busVal; }
+STUB uint32_t micros() { return busVal; }
+
+// Profile Usage ///////////////////////////////////////////////////////////////
+
+static volatile uint32_t sink = 0;
+
+#ifdef SIZE_BENCH_EMPTY
+int main() {
+	uint8_t val = busVal;
+	Wire.begin();
+	Wire.beginTransmission(val);
+	Wire.write(val);
+	Wire.write(&val, 1);
+	sink += Wire.endTransmission() + Wire.requestFrom(val, val) + Wire.available() + Wire.read();
+	sink += millis() + micros();
+
+	return 0;
+}
+#else
+AbraRTC RTC;
+
+int main() {
+	RTC.begin();
+	RTC.updateRTC();
+	sink += RTC.getHour10s() + RTC.getHour1s() + RTC.getMin10s() + RTC.getMin1s() +
+		RTC.getSec10s() + RTC.getSec1s() + RTC.getHrFormat() + RTC.getTimeOfDay();
+	sink += RTC.getSecOfDay() + RTC.getPowerFlags();
+
+#if ABRA_RTC_HAS_TEMP
+	sink += RTC.getTempF();
+#endif
+
+#ifndef SIZE_BENCH_BEGIN
+#if ABRA_RTC_HAS_SET
+	RTC.setRecoveryPolicy(busVal);
+	RTC.setTime(busVal, busVal, busVal, busVal);
+	RTC.setHrFormat(busVal);
+	RTC.toggleHrFormat();
+	RTC.incHour();
+	RTC.decHour();
+	RTC.incMin();
+	RTC.decMin();
+
+	RTC.beginConfig();
+	RTC.stageTime(busVal, busVal, busVal, busVal);
+	RTC.stageHrFormat(busVal);
+	RTC.stageField<AbraReg::INT_AIE>(busVal);
+	RTC.commitConfig();
+#endif
+
+#if ABRA_RTC_HAS_CONFIG
+	RTC.setTrickleCharge(busVal);
+	RTC.setClkOut(busVal);
+	RTC.enableClkOut(busVal);
+#endif
+
+#if ABRA_RTC_HAS_POWER_LOG
+	RTCPowerEvent event;
+	RTC.logAlive();
+	RTC.getPowerEvent(event);
+	sink += event.downSeconds;
+#endif
+#endif
+
+	return 0;
+}
+#endif
@@ -0,0 +1,132 @@
+#!/bin/sh
+#
+# Reports the flash and RAM cost of each ABRA_RTC_PROFILE
+#
+# Run from the library root:
+#   extras/size_bench/size_bench.sh [-v] [-b baseline.txt] [-w baseline.txt]
+#
+#   -v  also list every function and variable each profile adds, with its size
+#   -b  fail if any profile uses more text, data or bss than in baseline.txt
+#   -w  write this run's totals to baseline.txt
+#
+# Builds extras/size_bench/size_bench.cpp once per profile with --gc-sections,
+# calling every method (DISPLAY, FULL) and only begin(), updateRTC() and the
+# getters (DISPLAY-B, FULL-B, READONLY only has those), and reports the linked image size minus that of the same program built
+# without the library, so compiler runtime helpers the library pulls in
+# (soft float, 32 bit division) are counted along with its own code. Uses
+# avr-g++ for an ATmega328P if it is installed, otherwise the host g++, whose
+# sizes differ from AVR but move the same way. Override with CXX, MCU and
+# CXXFLAGS. Sizes depend on the compiler version, so a baseline is only
+# meaningful against the toolchain that wrote it, -w records it on the first
+# line and -b warns if it differs.
+#
+# extras/size_bench/baseline-host.txt holds the totals from the host g++ it
+# names, check a change with
+#   extras/size_bench/size_bench.sh -b extras/size_bench/baseline-host.txt
+# and rewrite it with -w when a change is meant to grow the library. Nothing
+# runs this automatically, regression checking is manual.
+
+set -e
+
+VERBOSE=0
+BASELINE=
+WRITE=
+while getopts "vb:w:" opt; do
+	case $opt in
+		v) VERBOSE=1 ;;
+		b) BASELINE=$OPTARG ;;
+		w) WRITE=$OPTARG ;;
+		*) exit 2 ;;
+	esac
+done
+
+if [ -z "$CXX" ]; then
+	if command -v avr-g++ >/dev/null 2>&1; then
+		CXX=avr-g++
+	else
+		CXX=g++
+	fi
+fi
+case $CXX in
+	*avr-g++*)
+		NM=${NM:-avr-nm}
+		SIZE=${SIZE:-avr-size}
+		CXXFLAGS="-mmcu=${MCU:-atmega328p} $CXXFLAGS"
+		;;
+	*)
+		NM=${NM:-nm}
+		SIZE=${SIZE:-size}
+		;;
+esac
+
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+build() {
+	$CXX -std=gnu++11 -fpermissive -w -Os -ffunction-sections -fdata-sections \
+		-Wl,--gc-sections $CXXFLAGS -I extras/host -I . "$@"
+}
+
+# text, data and bss of a linked image
+sizes() {
+	$SIZE "$1" | awk 'NR == 2 { print $1, $2, $3 }'
+}
+
+# the same stubs without the library
+build -DSIZE_BENCH_EMPTY -o "$OUT/EMPTY" extras/size_bench/size_bench.cpp
+EMPTY=$(sizes "$OUT/EMPTY")
+$NM -S -C "$OUT/EMPTY" > "$OUT/EMPTY.syms"
+
+COMPILER="# $($CXX --version | head -n 1)"
+echo "$COMPILER" > "$OUT/totals"
+echo "$COMPILER"
+echo "# profile      text  data   bss"
+
+for run in 1 2 3 2B 3B; do
+	flags=
+	case $run in
+		1) name=READONLY ;;
+		2) name=DISPLAY ;;
+		3) name=FULL ;;
+		2B) name=DISPLAY-B; flags=-DSIZE_BENCH_BEGIN ;;
+		3B) name=FULL-B; flags=-DSIZE_BENCH_BEGIN ;;
+	esac
+
+	build -DABRA_RTC_PROFILE=${run%B} $flags -o "$OUT/$name" extras/size_bench/size_bench.cpp AbraconRTC.cpp
+
+	echo "$name $(sizes "$OUT/$name") $EMPTY" |
+		awk '{ printf "%-10s %6d %5d %5d\n", $1, $2 - $5, $3 - $6, $4 - $7 }' | tee -a "$OUT/totals"
+
+	# detail: symbols that aren't in the empty build, library and runtime helpers alike
+	if [ $VERBOSE -eq 1 ]; then
+		$NM -S -C --size-sort "$OUT/$name" | awk '
+			NR == FNR { if (NF >= 4) { $1 = $2 = $3 = ""; empty[$0] = 1 } next }
+			NF >= 4 {
+				size = ("0x" $2) + 0
+				$1 = $2 = $3 = ""
+				if (!($0 in empty)) { printf "    %6d %s\n", size, substr($0, 4) }
+			}
+		' "$OUT/EMPTY.syms" -
+	fi
+done
+
+if [ -n "$WRITE" ]; then
+	cp "$OUT/totals" "$WRITE"
+fi
+
+if [ -n "$BASELINE" ]; then
+	if [ "$(head -n 1 "$BASELINE")" != "$COMPILER" ]; then
+		echo "warning: $BASELINE was written by another compiler:"
+		head -n 1 "$BASELINE"
+	fi
+	awk '
+		/^#/ { next }
+		NR == FNR { text[$1] = $2; data[$1] = $3; bss[$1] = $4; next }
+		($1 in text) && ($2 > text[$1] || $3 > data[$1] || $4 > bss[$1]) {
+			printf "%s grew: text %d -> %d, data %d -> %d, bss %d -> %d\n",
+				$1, text[$1], $2, data[$1], $3, bss[$1], $4
+			grew = 1
+		}
+		END { exit grew }
+	' "$BASELINE" "$OUT/totals"
+fi
@@ -0,0 +1,495 @@
+/*
+  Replays an AbraTrace capture against the AbraRTC driver on a host PC
+
+  Build from the library root:
+    g++ -std=gnu++11 -fpermissive -I extras/host -I . -o trace_replay \
+        -DABRA_RTC_TRACE=1 extras/trace_replay/trace_replay.cpp AbraconRTC.cpp \
+        AbraconRTCTrace.cpp extras/host/Arduino.cpp extras/host/SimRTC.cpp \
+        extras/host/HostCheck.cpp
+
+  Usage:
+    trace_replay [-m] capture.txt
+    trace_replay -r
+
+  capture.txt is the output of AbraTrace::dump(), lines starting with # are
+  ignored. Every public AbraRTC call in the capture is made again in order.
+  The recorded bus time only adds up the gaps within calls, the time between
+  calls comes from the millis() timestamp on each call record.
+
+  Strict mode (default) answers the driver with the captured bytes and
+  reports the first transaction that doesn't match the capture, reproducing
+  exactly what the driver saw in the field.
+
+  Model mode (-m) answers the driver from the extras/host/SimRTC register page,
+  seeded with the register values captured for each call, so a changed driver
+  can be run against real traffic and its bus cost compared with the capture.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "AbraconRTC.h"
+#include "AbraconRTCTrace.h"
+#include "HostCheck.h"
+#include "SimRTC.h"
+
+struct TraceRecord {
+	uint8_t i2cAddr;
+	uint8_t dir;
+	uint8_t reg;
+	uint8_t status;
+	uint16_t elapsed;
+	std::vector<uint8_t> data;
+};
+
+struct BusStats {
+	uint32_t transactions;
+	uint32_t bytes;
+	uint32_t micros;
+};
+
+static std::vector<TraceRecord> records;
+static size_t cursor = 0;
+static size_t segmentEnd = 0;
+static bool modelMode = 0;
+static bool mismatch = 0;
+static uint32_t calls = 0;
+static uint32_t firstMillis = 0;
+static uint32_t lastMillis = 0;
+
+static BusStats recorded = {0};
+
+AbraRTC RTC;
+
+// host time, only moved by the self-test, each micros() read takes 20 us
+static uint32_t hostMicros = 0;
+uint32_t millis() { return hostMicros / 1000; }
+uint32_t micros() { return hostMicros += 20; }
+
+// Trace Parsing ///////////////////////////////////////////////////////////////
+
+static int hexVal(char c) {
+	if (c >= '0' && c <= '9') { return c - '0'; }
+	if (c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+	if (c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+	return -1;
+}
+
+// read the output of AbraTrace::dump() into records
+static bool loadTrace(FILE *file) {
+	char line[1024];
+	unsigned lineNum = 0;
+	while (fgets(line, sizeof(line), file)) {
+		lineNum++;
+		if (line[0] == '#') { continue; }
+
+		std::vector<uint8_t> bytes;
+		int hi = -1;
+		for (char *c = line; *c; c++) {
+			if (isspace((unsigned char)*c)) { continue; }
+			int val = hexVal(*c);
+			if (val < 0) {
+				fprintf(stderr, "line %u: bad hex digit '%c'\n", lineNum, *c);
+				return 0;
+			}
+			if (hi < 0) {
+				hi = val;
+			} else {
+				bytes.push_back((hi << 4) | val);
+				hi = -1;
+			}
+		}
+		if (bytes.empty()) { continue; }
+
+		if ((bytes.size() < TRACE_HEADER_SIZE) || (bytes.size() != (size_t)(TRACE_HEADER_SIZE + bytes[2]))) {
+			fprintf(stderr, "line %u: truncated record\n", lineNum);
+			return 0;
+		}
+
+		TraceRecord rec;
+		rec.i2cAddr = bytes[0] >> 1;
+		rec.dir     = bytes[0] & 0x01;
+		rec.reg     = bytes[1];
+		rec.status  = bytes[3];
+		rec.elapsed = bytes[4] | (bytes[5] << 8);
+		rec.data.assign(bytes.begin() + TRACE_HEADER_SIZE, bytes.end());
+		records.push_back(rec);
+	}
+
+	return 1;
+}
+
+static bool isCall(const TraceRecord &rec) {
+	return (rec.i2cAddr == TRACE_CALL_ADDR);
+}
+
+// millis() time a call was made, 0 for captures made before call records had one
+static uint32_t callMillis(const TraceRecord &call) {
+	if (call.data.size() < TRACE_CALL_ARGS + TRACE_CALL_STAMP) { return 0; }
+	const uint8_t *stamp = &call.data[TRACE_CALL_ARGS];
+	return stamp[0] | (stamp[1] << 8) | ((uint32_t)stamp[2] << 16) | ((uint32_t)stamp[3] << 24);
+}
+
+static const char *callName(uint8_t id) {
+	switch (id) {
+		case TRACE_CALL_BEGIN:				return "begin";
+		case TRACE_CALL_UPDATE:				return "updateRTC";
+		case TRACE_CALL_SET_TIME:			return "setTime";
+		case TRACE_CALL_SET_TRICKLE_CHARGE:	return "setTrickleCharge";
+		case TRACE_CALL_SET_HR_FORMAT:		return "setHrFormat";
+		case TRACE_CALL_TOGGLE_HR_FORMAT:	return "toggleHrFormat";
+		case TRACE_CALL_INC_HOUR:			return "incHour";
+		case TRACE_CALL_DEC_HOUR:			return "decHour";
+		case TRACE_CALL_INC_MIN:			return "incMin";
+		case TRACE_CALL_DEC_MIN:			return "decMin";
+		case TRACE_CALL_BEGIN_CONFIG:		return "beginConfig";
+		case TRACE_CALL_STAGE_TIME:			return "stageTime";
+		case TRACE_CALL_STAGE_HR_FORMAT:	return "stageHrFormat";
+		case TRACE_CALL_STAGE_BITS:			return "stageBits";
+		case TRACE_CALL_COMMIT_CONFIG:		return "commitConfig";
+		case TRACE_CALL_SET_CLKOUT:			return "setClkOut";
+		case TRACE_CALL_ENABLE_CLKOUT:		return "enableClkOut";
+		case TRACE_CALL_SET_RECOVERY_POLICY: return "setRecoveryPolicy";
+		case TRACE_CALL_LOG_ALIVE:			return "logAlive";
+		case TRACE_CALL_GET_POWER_EVENT:	return "getPowerEvent";
+		case TRACE_CALL_READ_FIELD:			return "readField";
+		case TRACE_CALL_WRITE_FIELD:		return "writeField";
+	}
+	return "unknown";
+}
+
+// Captured Bus ////////////////////////////////////////////////////////////////
+
+static void reportMismatch(const char *what, uint8_t reg) {
+	if (!mismatch) {
+		fprintf(stderr, "mismatch at record %zu: driver %s register 0x%02X\n", cursor, what, reg);
+	}
+	mismatch = 1;
+}
+
+// next captured bus record within the current call, or 0 if there is none
+static const TraceRecord *nextRecord() {
+	if (cursor >= segmentEnd) { return 0; }
+	return &records[cursor];
+}
+
+// answers the driver with the captured bytes, in strict mode
+class CaptureDevice : public SimDevice {
+	public:
+		uint8_t select(uint8_t reg);
+		uint8_t write(uint8_t reg, const uint8_t *vals, uint8_t len);
+		uint8_t read(uint8_t reg, uint8_t *vals, uint8_t len);
+};
+
+uint8_t CaptureDevice::select(uint8_t reg) {
+	const TraceRecord *rec = nextRecord();
+	if (!rec || (rec->dir != TRACE_READ) || (rec->reg != reg)) {
+		reportMismatch("selected", reg);
+		return 4;
+	}
+	if ((rec->status != 0) && (rec->status != TRACE_SHORT_READ)) { // select failed in the field
+		cursor++;
+		return rec->status;
+	}
+	return 0;
+}
+
+uint8_t CaptureDevice::write(uint8_t reg, const uint8_t *vals, uint8_t len) {
+	const TraceRecord *rec = nextRecord();
+	if (!rec || (rec->dir != TRACE_WRITE) || (rec->reg != reg) || (rec->data.size() != len) ||
+		memcmp(&rec->data[0], vals, len)) {
+		reportMismatch("wrote", reg);
+		return 4;
+	}
+	cursor++;
+	return rec->status;
+}
+
+uint8_t CaptureDevice::read(uint8_t reg, uint8_t *vals, uint8_t len) {
+	const TraceRecord *rec = nextRecord();
+	if (!rec || (rec->dir != TRACE_READ) || (rec->reg != reg)) {
+		reportMismatch("read", reg);
+		return 0;
+	}
+	cursor++;
+	if (rec->status != 0) { return 0; }
+	if (rec->data.size() != len) {
+		reportMismatch("read a different length from", reg);
+		return 0;
+	}
+	memcpy(vals, &rec->data[0], len);
+	return len;
+}
+
+static CaptureDevice captureDevice;
+
+// Replay //////////////////////////////////////////////////////////////////////
+
+static bool dispatch(uint8_t id, const std::vector<uint8_t> &args) {
+	switch (id) {
+		case TRACE_CALL_BEGIN:				return RTC.begin();
+		case TRACE_CALL_UPDATE:				return RTC.updateRTC();
+		case TRACE_CALL_SET_TIME:			return RTC.setTime(args[0], args[1], args[2], args[3]);
+		case TRACE_CALL_SET_TRICKLE_CHARGE:	return RTC.setTrickleCharge(args[0]);
+		case TRACE_CALL_SET_HR_FORMAT:		return RTC.setHrFormat(args[0]);
+		case TRACE_CALL_TOGGLE_HR_FORMAT:	return RTC.toggleHrFormat();
+		case TRACE_CALL_INC_HOUR:			return RTC.incHour();
+		case TRACE_CALL_DEC_HOUR:			return RTC.decHour();
+		case TRACE_CALL_INC_MIN:			return RTC.incMin();
+		case TRACE_CALL_DEC_MIN:			return RTC.decMin();
+		case TRACE_CALL_BEGIN_CONFIG:		RTC.beginConfig(); return 1;
+		case TRACE_CALL_STAGE_TIME:			return RTC.stageTime(args[0], args[1], args[2], args[3]);
+		case TRACE_CALL_STAGE_HR_FORMAT:	RTC.stageHrFormat(args[0]); return 1;
+		case TRACE_CALL_STAGE_BITS:			RTC.stageBits(args[0], args[1], args[2]); return 1;
+		case TRACE_CALL_COMMIT_CONFIG:		return RTC.commitConfig();
+		case TRACE_CALL_SET_CLKOUT:			return RTC.setClkOut(args[0]);
+		case TRACE_CALL_ENABLE_CLKOUT:		return RTC.enableClkOut(args[0]);
+		case TRACE_CALL_SET_RECOVERY_POLICY: RTC.setRecoveryPolicy(args[0]); return 1;
+		case TRACE_CALL_LOG_ALIVE:			return RTC.logAlive();
+		case TRACE_CALL_GET_POWER_EVENT:	{ RTCPowerEvent event; return RTC.getPowerEvent(event); }
+		case TRACE_CALL_READ_FIELD:			{ uint8_t val; return RTC.readBits(args[0], args[1], val); }
+		case TRACE_CALL_WRITE_FIELD:		return RTC.writeBits(args[0], args[1], args[2]);
+	}
+	fprintf(stderr, "unknown call id %u\n", id);
+	return 0;
+}
+
+// replay every call in records, stopping at the first mismatch in strict mode
+static void replay() {
+	cursor = 0;
+	mismatch = 0;
+	calls = 0;
+	firstMillis = 0;
+	lastMillis = 0;
+	memset(&recorded, 0, sizeof(recorded));
+	SimRTC::transactions = 0;
+	SimRTC::bytes = 0;
+
+	// skip bus records captured before the first call marker
+	while ((cursor < records.size()) && !isCall(records[cursor])) {
+		cursor++;
+	}
+
+	while (cursor < records.size()) {
+		const TraceRecord &call = records[cursor++];
+		lastMillis = callMillis(call);
+		if (!calls) {
+			firstMillis = lastMillis;
+		}
+		segmentEnd = cursor;
+		bool seeded[256] = {0}; // registers take their first captured value in the call
+		while ((segmentEnd < records.size()) && !isCall(records[segmentEnd])) {
+			const TraceRecord &rec = records[segmentEnd++];
+			recorded.transactions++;
+			recorded.bytes += (rec.dir == TRACE_READ) ? (3 + rec.data.size()) : (2 + rec.data.size());
+			recorded.micros += rec.elapsed;
+
+			if (modelMode && (rec.dir == TRACE_READ) && (rec.status == 0)) {
+				for (size_t i = 0; i < rec.data.size(); i++) {
+					uint8_t reg = rec.reg + i;
+					if (!seeded[reg]) {
+						SimRTC::regs[reg] = rec.data[i];
+						seeded[reg] = 1;
+					}
+				}
+			}
+		}
+
+		std::vector<uint8_t> args(call.data);
+		args.resize(TRACE_CALL_ARGS, 0);
+		bool ok = dispatch(call.reg, args);
+		calls++;
+
+		if (!modelMode && !mismatch && (cursor != segmentEnd)) {
+			reportMismatch("stopped before the capture in call to", call.reg);
+		}
+		if (mismatch) {
+			fprintf(stderr, "in call %u at %u ms: %s() returned %d\n", calls, lastMillis, callName(call.reg), ok);
+			break;
+		}
+		cursor = segmentEnd;
+	}
+}
+
+// Self-Test ///////////////////////////////////////////////////////////////////
+
+#if ABRA_RTC_TRACE
+// prints into a file, standing in for Serial
+class FilePrint : public Print {
+	private:
+		FILE *file;
+	public:
+		FilePrint(FILE *out) : file(out) {}
+		size_t write(uint8_t val) { return (fputc(val, file) == EOF) ? 0 : 1; }
+};
+
+/*
+  Description
+    record the same session of calls against SimRTC each time, including an
+    address NACK and a short read, and dump it
+  Input
+    buf: trace ring buffer
+    size: size of buf in bytes
+    dropped: records AbraTrace dropped to make room
+    endMillis: millis() time of the last call
+  Return
+    dump output, rewound, to be closed by the caller
+*/
+static FILE *recordSession(uint8_t *buf, uint16_t size, uint16_t &dropped, uint32_t &endMillis) {
+	memset(SimRTC::regs, 0, sizeof(SimRTC::regs));
+	SimRTC::regs[CTL_1_ADDR]    = AbraReg::CTL1_EERE::mask;
+	SimRTC::regs[CTL_STAT_ADDR] = AbraReg::STAT_PON::mask;
+	SimRTC::regs[TEMP_ADDR]     = 85;
+	SimRTC::setClock(9, 59, 58, 3);
+	hostMicros = 1000000;
+
+	AbraTrace::attach(buf, size);
+	RTC.begin();
+	for (uint8_t i = 0; i < 4; i++) {
+		hostMicros += 250000;
+		RTC.updateRTC();
+	}
+	hostMicros += 250000;
+	SimRTC::failStatus = 2; // address NACK on the register select
+	RTC.updateRTC();
+	hostMicros += 250000;
+	SimRTC::failShort = 1;
+	RTC.updateRTC();
+	hostMicros += 250000;
+	RTC.setTime(12, 30, 0);
+	hostMicros += 250000;
+	RTC.writeField<AbraReg::INT_AIE>(1);
+	hostMicros += 250000;
+	endMillis = millis();
+	RTC.updateRTC();
+
+	dropped = AbraTrace::dropped();
+	FILE *file = tmpfile();
+	FilePrint out(file);
+	AbraTrace::dump(out);
+	AbraTrace::detach();
+	rewind(file);
+	return file;
+}
+
+// lines of a dump, records only
+static std::vector<std::string> dumpLines(FILE *file) {
+	std::vector<std::string> lines;
+	char line[1024];
+	while (fgets(line, sizeof(line), file)) {
+		if (line[0] != '#') {
+			lines.push_back(line);
+		}
+	}
+	rewind(file);
+	return lines;
+}
+
+static bool hasStatus(uint8_t dir, uint8_t status) {
+	for (size_t i = 0; i < records.size(); i++) {
+		if (!isCall(records[i]) && (records[i].dir == dir) && (records[i].status == status)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+  Description
+    record a session into a ring buffer large enough for all of it and into
+    one that wraps, dump both and replay the wrapped one in strict mode
+  Return
+    exit status, 1 if any check failed
+*/
+static int selfTest() {
+	static uint8_t largeBuf[1024];
+	static uint8_t smallBuf[96]; // sized so a record kept at the end straddles the buffer end
+	uint16_t largeDropped = 0;
+	uint16_t smallDropped = 0;
+	uint32_t endMillis = 0;
+
+	FILE *largeDump = recordSession(largeBuf, sizeof(largeBuf), largeDropped, endMillis);
+	FILE *smallDump = recordSession(smallBuf, sizeof(smallBuf), smallDropped, endMillis);
+	HostCheck::check(AbraTrace::available() == 0, "dump: ring buffer left empty");
+
+	std::vector<std::string> largeLines = dumpLines(largeDump);
+	std::vector<std::string> smallLines = dumpLines(smallDump);
+	char first[32] = {0};
+	fgets(first, sizeof(first), smallDump);
+	rewind(smallDump);
+
+	HostCheck::check(largeDropped == 0, "record, large buffer: nothing dropped");
+	HostCheck::check(smallDropped > 0, "record, small buffer: wrapped around, oldest records dropped");
+	HostCheck::check(!strncmp(first, "# dropped ", 10), "dump, small buffer: dropped count printed first");
+	HostCheck::check(!smallLines.empty() && (smallLines.size() < largeLines.size()) &&
+		std::equal(smallLines.begin(), smallLines.end(), largeLines.end() - smallLines.size()),
+		"dump, small buffer: the newest records of the large buffer, unchanged");
+
+	records.clear();
+	bool loaded = loadTrace(largeDump);
+	HostCheck::check(loaded && hasStatus(TRACE_READ, 2), "record: address NACK kept with status 2");
+	HostCheck::check(loaded && hasStatus(TRACE_READ, TRACE_SHORT_READ), "record: short read kept with TRACE_SHORT_READ");
+	HostCheck::check(loaded && isCall(records[records.size() - 3]) && (records[records.size() - 3].elapsed == 0xFFFF),
+		"record: microsecond delta saturates at 0xFFFF after 250 ms");
+
+	// replay the capture that starts part way into a call
+	records.clear();
+	loaded = loadTrace(smallDump);
+	SimRTC::device = &captureDevice;
+	replay();
+	HostCheck::check(loaded && calls && !mismatch, "replay, small buffer: every call matches the capture");
+	HostCheck::check(recorded.transactions == SimRTC::transactions, "replay, small buffer: same number of transactions");
+	HostCheck::check(lastMillis == endMillis, "replay, small buffer: last call at the recorded millis() time");
+
+	fclose(largeDump);
+	fclose(smallDump);
+	return HostCheck::status();
+}
+#else
+static int selfTest() {
+	fprintf(stderr, "-r needs a build with -DABRA_RTC_TRACE=1\n");
+	return 2;
+}
+#endif
+
+int main(int argc, char **argv) {
+	const char *path = 0;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-m")) {
+			modelMode = 1;
+		} else if (!strcmp(argv[i], "-r")) {
+			return selfTest();
+		} else {
+			path = argv[i];
+		}
+	}
+	if (!path) {
+		fprintf(stderr, "usage: %s [-m] capture.txt | -r\n", argv[0]);
+		return 2;
+	}
+
+	FILE *file = fopen(path, "r");
+	if (!file) {
+		fprintf(stderr, "can't open %s\n", path);
+		return 2;
+	}
+	bool loaded = loadTrace(file);
+	fclose(file);
+	if (!loaded) { return 2; }
+
+	if (!modelMode) {
+		SimRTC::device = &captureDevice;
+	}
+	replay();
+
+	printf("calls replayed:     %u over %u ms\n", calls, lastMillis - firstMillis);
+	printf("recorded bus:       %u transactions, %u bytes, %u us\n",
+		recorded.transactions, recorded.bytes, recorded.micros);
+	printf("replayed bus:       %u transactions, %u bytes\n",
+		SimRTC::transactions, SimRTC::bytes);
+
+	return mismatch ? 1 : 0;
+}